@@ -0,0 +1,10 @@
+TEMPLATE = app
+TARGET = pwgen_bench
+
+# Google Benchmark suite for libpwgen, no Qt modules
+CONFIG -= qt
+CONFIG += c++11 console
+
+SOURCES += pwgen_bench.cpp \
+           ../libpwgen/pwgen.cpp
+LIBS += -lbenchmark -lpthread
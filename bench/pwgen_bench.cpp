@@ -0,0 +1,236 @@
+// Microbenchmarks for libpwgen: generation, strength scoring, RNG backends.
+//
+// Build (from the repository root):
+//   g++ -O2 -std=c++11 -o pwgen_bench bench/pwgen_bench.cpp libpwgen/pwgen.cpp -lbenchmark -pthread
+// Track regressions with JSON output:
+//   ./pwgen_bench --benchmark_out=bench.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../libpwgen/charset_kernel.h"
+#include "../libpwgen/estimator.h"
+#include "../libpwgen/pwgen.h"
+#include "../libpwgen/secure_random.h"
+#include "../libpwgen/strength.h"
+
+namespace {
+
+// Charset argument for the generation benchmarks
+enum Charset {
+    CharsetAll = 0,       // upper, lower, digits, special
+    CharsetAlnum = 1,     // no special (-s)
+    CharsetDigits = 2,    // digits only (-d)
+};
+
+// Option flags argument
+enum Flags {
+    FlagEnforceMinimum = 1,
+    FlagAvoidSimilar = 2,
+};
+
+pwgen_options makeOptions(int charset, int flags, int rng = PWGEN_RNG_CHACHA20) {
+    pwgen_options options;
+    pwgen_options_init(&options);
+    options.use_upper = charset != CharsetDigits;
+    options.use_lower = charset != CharsetDigits;
+    options.use_digits = 1;
+    options.use_special = charset == CharsetAll;
+    options.enforce_minimum = (flags & FlagEnforceMinimum) != 0;
+    options.avoid_similar = (flags & FlagAvoidSimilar) != 0;
+    options.rng = rng;
+    return options;
+}
+
+struct ContextDeleter {
+    void operator()(pwgen_ctx* ctx) const { pwgen_free(ctx); }
+};
+typedef std::unique_ptr<pwgen_ctx, ContextDeleter> ContextPtr;
+
+void GenerateArgs(benchmark::internal::Benchmark* b) {
+    for (int length : {8, 16, 64, 512, 4096}) {
+        for (int charset : {0, 1, 2}) { // Charset values
+            for (int flags : {0, 1, 2, 3}) { // combinations of Flags
+                b->Args({length, charset, flags});
+            }
+        }
+    }
+    b->ArgNames({"length", "charset", "flags"});
+}
+
+// One password per call, as the CLI and GUI generate()
+void BM_Generate(benchmark::State& state) {
+    const size_t length = static_cast<size_t>(state.range(0));
+    pwgen_options options = makeOptions(static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+    ContextPtr ctx(pwgen_ctx_new(&options));
+    std::string password(length, '\0');
+    for (auto _ : state) {
+        pwgen_generate(ctx.get(), &password[0], length);
+        benchmark::DoNotOptimize(password.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(length));
+}
+BENCHMARK(BM_Generate)->Apply(GenerateArgs);
+
+// Newline-delimited batches, as pwgen -N bulk workers fill them
+void BM_GenerateBatch(benchmark::State& state) {
+    const size_t length = static_cast<size_t>(state.range(0));
+    const size_t count = std::max<size_t>(1, (1 << 20) / (length + 1));
+    pwgen_options options = makeOptions(static_cast<int>(state.range(1)), static_cast<int>(state.range(2)));
+    ContextPtr ctx(pwgen_ctx_new(&options));
+    std::vector<char> arena(count * (length + 1), '\n');
+    for (auto _ : state) {
+        pwgen_generate_batch(ctx.get(), arena.data(), count, length, length + 1);
+        benchmark::DoNotOptimize(arena.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(arena.size()));
+}
+BENCHMARK(BM_GenerateBatch)->Apply(GenerateArgs);
+
+// Seeded generation of the same password every iteration: a fixed amount of
+// work (no run-to-run variance from rejection sampling) for comparing kernels
+void BM_GenerateSeeded(benchmark::State& state) {
+    const size_t length = static_cast<size_t>(state.range(0));
+    pwgen_options options = makeOptions(static_cast<int>(state.range(1)), static_cast<int>(state.range(2)),
+                                        PWGEN_RNG_SEEDED);
+    ContextPtr ctx(pwgen_ctx_new(&options));
+    std::string password(length, '\0');
+    for (auto _ : state) {
+        pwgen_seek(ctx.get(), 0, 0);
+        pwgen_generate(ctx.get(), &password[0], length);
+        benchmark::DoNotOptimize(password.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(length));
+}
+BENCHMARK(BM_GenerateSeeded)->Apply(GenerateArgs);
+
+// Strength scoring; bytes processed gives the cost per character
+void BM_CalculateStrength(benchmark::State& state) {
+    const size_t length = static_cast<size_t>(state.range(0));
+    // Seeded, so every run scores the same password
+    pwgen_options options = makeOptions(CharsetAll, FlagEnforceMinimum, PWGEN_RNG_SEEDED);
+    ContextPtr ctx(pwgen_ctx_new(&options));
+    std::string password(length, '\0');
+    pwgen_generate(ctx.get(), &password[0], length);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pwgen::calculateStrength(password));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(length));
+}
+BENCHMARK(BM_CalculateStrength)->RangeMultiplier(8)->Range(8, 4096)->ArgName("length");
+
+// Pattern-matching estimate, as the GUI runs on every keystroke. Set
+// PWGEN_DICT to a compiled dictionary to include dictionary matching.
+void BM_EstimateStrength(benchmark::State& state) {
+    static const char* const passwords[] = {
+        "Password123!",         // dictionary + bruteforce
+        "qwertyuiop1qaz2wsx",   // keyboard walks
+        "12/25/1990abcabcabc",  // date + repeat
+        "W$GYelMJ-?h9l4cYk7vQ!rZ2p#Lm8xT&", // random, 32 characters
+    };
+    const char* password = passwords[state.range(0)];
+    const size_t length = strlen(password);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pwgen::estimateStrength(password, length).guessesLog10);
+    }
+    state.SetLabel(pwgen::defaultDictionary().empty() ? "no dictionary" : "dictionary");
+}
+BENCHMARK(BM_EstimateStrength)->DenseRange(0, 3)->ArgName("password");
+
+// Cost of seeding a random source, as initSecureRandom() does
+void BM_SeedRandomSource(benchmark::State& state) {
+    const pwgen::RandomBackend backend = static_cast<pwgen::RandomBackend>(state.range(0));
+    for (auto _ : state) {
+        std::unique_ptr<pwgen::RandomSource> source = pwgen::makeRandomSource(backend);
+        benchmark::DoNotOptimize(source.get());
+    }
+    state.SetLabel(pwgen::randomBackendName(backend));
+}
+BENCHMARK(BM_SeedRandomSource)
+    ->Arg(static_cast<int>(pwgen::RandomBackend::System))
+    ->Arg(static_cast<int>(pwgen::RandomBackend::ChaCha20))
+    ->Arg(static_cast<int>(pwgen::RandomBackend::Mt19937))
+    ->ArgName("backend");
+
+// The original seeding: 312 std::random_device calls into a seed_seq
+void BM_SeedLegacyRandomDevice(benchmark::State& state) {
+    for (auto _ : state) {
+        std::random_device rd;
+        std::mt19937_64 engine;
+        std::array<unsigned int, std::mt19937_64::state_size> seedData;
+        std::generate(seedData.begin(), seedData.end(), std::ref(rd));
+        std::seed_seq seq(seedData.begin(), seedData.end());
+        engine.seed(seq);
+        benchmark::DoNotOptimize(engine);
+    }
+}
+BENCHMARK(BM_SeedLegacyRandomDevice);
+
+// Full context creation: policy compile plus seeding
+void BM_ContextNew(benchmark::State& state) {
+    pwgen_options options = makeOptions(CharsetAll, FlagEnforceMinimum);
+    for (auto _ : state) {
+        ContextPtr ctx(pwgen_ctx_new(&options));
+        benchmark::DoNotOptimize(ctx.get());
+    }
+}
+BENCHMARK(BM_ContextNew);
+
+// Sustained RNG output per backend
+void BM_RandomFill(benchmark::State& state) {
+    const pwgen::RandomBackend backend = static_cast<pwgen::RandomBackend>(state.range(0));
+    std::unique_ptr<pwgen::RandomSource> source = pwgen::makeRandomSource(backend);
+    std::vector<unsigned char> block(64 * 1024);
+    for (auto _ : state) {
+        source->fill(block.data(), block.size());
+        benchmark::DoNotOptimize(block.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(block.size()));
+    state.SetLabel(source->name());
+}
+BENCHMARK(BM_RandomFill)
+    ->Arg(static_cast<int>(pwgen::RandomBackend::System))
+    ->Arg(static_cast<int>(pwgen::RandomBackend::ChaCha20))
+    ->Arg(static_cast<int>(pwgen::RandomBackend::Mt19937))
+    ->Arg(static_cast<int>(pwgen::RandomBackend::Seeded))
+    ->ArgName("backend");
+
+// Byte-to-character kernel per SIMD level, over a fixed random buffer
+void BM_CharsetKernel(benchmark::State& state) {
+    const pwgen::SimdLevel level = static_cast<pwgen::SimdLevel>(state.range(0));
+    if (static_cast<int>(level) > static_cast<int>(pwgen::detectSimdLevel())) {
+        state.SkipWithError("not supported on this CPU");
+        return;
+    }
+    pwgen::CharsetKernel kernel("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789"
+                                "!@#$%^&*()-_=+[]{};:,.<>?/", level);
+    std::vector<uint8_t> bytes(64 * 1024);
+    pwgen::makeRandomSource()->fill(bytes.data(), bytes.size());
+    std::vector<char> out(bytes.size());
+    for (auto _ : state) {
+        size_t consumed;
+        benchmark::DoNotOptimize(kernel.map(bytes.data(), bytes.size(), out.data(), out.size(), consumed));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes.size()));
+    state.SetLabel(pwgen::simdLevelName(level));
+}
+BENCHMARK(BM_CharsetKernel)
+    ->Arg(static_cast<int>(pwgen::SimdLevel::Scalar))
+    ->Arg(static_cast<int>(pwgen::SimdLevel::SSE41))
+    ->Arg(static_cast<int>(pwgen::SimdLevel::AVX2))
+    ->ArgName("simd");
+
+} // namespace
+
+BENCHMARK_MAIN();
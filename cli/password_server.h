@@ -0,0 +1,478 @@
+#ifndef PWGEN_PASSWORD_SERVER_H
+#define PWGEN_PASSWORD_SERVER_H
+
+// `pwgen --serve <socket>`: a long-lived generator answering requests on a
+// Unix domain socket, so callers that need many credentials pay for one
+// process start and one seeding instead of one per password.
+//
+// Protocol (all integers big-endian). Every message is a frame: a uint32
+// body length followed by the body. Clients may pipeline requests.
+//
+//   Request body (8 bytes):
+//     uint8  version   SERVE_VERSION
+//     uint8  flags     SERVE_* policy bits; 0 = the policy pwgen was started with
+//     uint16 length    password length; 0 = the length pwgen was started with
+//     uint32 count     passwords wanted, 1..SERVE_MAX_COUNT, and no more
+//                      than SERVE_MAX_RESPONSE bytes of passwords in all
+//
+//   Response body:
+//     int32  status    PWGEN_OK or a PWGEN_* error code
+//     then, if OK, `count` passwords of `length` characters, each followed
+//     by '\n'
+//
+// A malformed frame closes the connection; a request the policy can't
+// satisfy gets an error status. One thread serves every client from an
+// epoll loop. Requests for the server's own policy and length are answered
+// from a locked pool a background thread keeps full; others are cut from a
+// pre-generated batch per policy and length. Either way a password is wiped
+// from the server's memory once sent. Given a breached-password corpus, both
+// the pool and the batches redraw any password found in it before it is
+// handed out; a policy that keeps producing breached ones gets PWGEN_EINVAL.
+//
+// Linux only (epoll, signalfd). The socket is created mode 0600.
+
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../libpwgen/breach.h"
+#include "../libpwgen/password_pool.h"
+#include "../libpwgen/pwgen.h"
+#include "../libpwgen/secure_memory.h"
+
+const uint8_t SERVE_VERSION = 1;
+
+// Request policy flags
+const uint8_t SERVE_UPPER = 1 << 0;
+const uint8_t SERVE_LOWER = 1 << 1;
+const uint8_t SERVE_DIGITS = 1 << 2;
+const uint8_t SERVE_SPECIAL = 1 << 3;
+const uint8_t SERVE_AVOID_SIMILAR = 1 << 4;
+const uint8_t SERVE_ENFORCE_MINIMUM = 1 << 5;
+
+const uint32_t SERVE_MAX_COUNT = 100000;
+const size_t SERVE_MAX_LENGTH = 1024;
+const size_t SERVE_MAX_RESPONSE = 4 << 20;   // count * (length + 1) bytes
+
+class PasswordServer {
+public:
+    // `defaults` and `defaultLength` answer requests with flags or length 0.
+    // `corpus`, if not null, screens everything served.
+    PasswordServer(const pwgen_options& defaults, size_t defaultLength,
+                   const pwgen::BreachCorpus* corpus = nullptr)
+        : defaultOptions(defaults), defaultLength(defaultLength), breachCorpus(corpus),
+          readyPool(pwgen::PasswordPool::DEFAULT_CAPACITY, pwgen::PasswordPool::DEFAULT_BYTES, corpus) {}
+
+    ~PasswordServer() {
+        for (auto& client : clients) {
+            wipe(client.second.in);
+            wipe(client.second.out);
+            ::close(client.first);
+        }
+        if (listenFd >= 0) {
+            ::close(listenFd);
+            unlink(socketPath.c_str());
+        }
+        if (signalFd >= 0) ::close(signalFd);
+        if (epollFd >= 0) ::close(epollFd);
+    }
+
+    // Bind the socket; false (with a message on stderr) on failure
+    bool listen(const std::string& path) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "Error: Socket path must be 1-" << sizeof(addr.sun_path) - 1
+                      << " characters." << std::endl;
+            return false;
+        }
+        memcpy(addr.sun_path, path.c_str(), path.size());
+
+        // Replace a stale socket left by a crashed server, but not a live one
+        struct stat st;
+        if (lstat(path.c_str(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) {
+                std::cerr << "Error: " << path << " exists and is not a socket." << std::endl;
+                return false;
+            }
+            int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            bool live = probe >= 0 &&
+                        connect(probe, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0;
+            if (probe >= 0) ::close(probe);
+            if (live) {
+                std::cerr << "Error: Another server is already listening on " << path << "." << std::endl;
+                return false;
+            }
+            unlink(path.c_str());
+        }
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) {
+            std::cerr << "Error: Cannot create socket: " << strerror(errno) << std::endl;
+            return false;
+        }
+        mode_t previous = umask(0177);
+        int rc = bind(listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        umask(previous);
+        if (rc != 0 || ::listen(listenFd, SOMAXCONN) != 0) {
+            std::cerr << "Error: Cannot listen on " << path << ": " << strerror(errno) << std::endl;
+            ::close(listenFd);
+            listenFd = -1;
+            return false;
+        }
+        socketPath = path;
+        return true;
+    }
+
+    // Serve until SIGINT or SIGTERM; false on a setup or epoll failure. The
+    // caller must block both signals before constructing the server, since
+    // the ready pool's refill thread starts in the constructor.
+    bool run() {
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+        signal(SIGPIPE, SIG_IGN);
+
+        signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (signalFd < 0 || epollFd < 0 || !watch(listenFd, EPOLLIN, EPOLL_CTL_ADD) ||
+            !watch(signalFd, EPOLLIN, EPOLL_CTL_ADD)) {
+            std::cerr << "Error: Cannot set up the event loop: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        std::vector<struct epoll_event> events(64);
+        for (;;) {
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Error: epoll_wait failed: " << strerror(errno) << std::endl;
+                return false;
+            }
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == signalFd) {
+                    return true;
+                } else if (fd == listenFd) {
+                    acceptClients();
+                } else {
+                    serviceClient(fd, events[i].events);
+                }
+            }
+        }
+    }
+
+private:
+    static const size_t FRAME_HEADER = 4;
+    static const size_t REQUEST_SIZE = 8;
+    static const size_t POOL_BYTES = 64 * 1024;   // refill size of one pool
+    static const size_t MAX_POOLS = 256;           // distinct policy/length pairs kept warm
+    static const size_t OUTPUT_HIGH_WATER = SERVE_MAX_RESPONSE;
+
+    // Pre-generated passwords for one policy and length, handed out in order
+    struct Pool {
+        pwgen_ctx* context = nullptr;
+        size_t length = 0;
+        pwgen::SecureBytes passwords;   // back-to-back, no delimiters
+        size_t next = 0;               // offset of the first unused password
+
+        Pool() {}
+        ~Pool() {
+            wipe(passwords);
+            pwgen_free(context);
+        }
+
+    private:
+        Pool(const Pool&);
+        Pool& operator=(const Pool&);
+    };
+
+    struct Client {
+        pwgen::SecureBytes in;
+        pwgen::SecureBytes out;
+        size_t sent = 0;
+        uint32_t watching = EPOLLIN;
+        bool peerClosed = false;       // no more requests, answer what we have
+    };
+
+    pwgen_options defaultOptions;
+    size_t defaultLength;
+    const pwgen::BreachCorpus* breachCorpus;   // null = no screening
+    std::string socketPath;
+    int listenFd = -1;
+    int signalFd = -1;
+    int epollFd = -1;
+    std::map<int, Client> clients;
+    std::map<uint32_t, std::unique_ptr<Pool>> pools;
+    pwgen::PasswordPool readyPool;  // default policy and length, refilled in the background
+
+    PasswordServer(const PasswordServer&);
+    PasswordServer& operator=(const PasswordServer&);
+
+    // Hand the buffer back to the secure arena, which wipes it
+    static void wipe(pwgen::SecureBytes& buffer) {
+        pwgen::SecureBytes().swap(buffer);
+    }
+
+    static uint32_t readU32(const char* p) {
+        const unsigned char* b = reinterpret_cast<const unsigned char*>(p);
+        return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | b[3];
+    }
+
+    static void appendU32(pwgen::SecureBytes& out, uint32_t value) {
+        out.push_back(static_cast<char>(value >> 24));
+        out.push_back(static_cast<char>(value >> 16));
+        out.push_back(static_cast<char>(value >> 8));
+        out.push_back(static_cast<char>(value));
+    }
+
+    bool watch(int fd, uint32_t events, int op) {
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        return epoll_ctl(epollFd, op, fd, &event) == 0;
+    }
+
+    void acceptClients() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                // EAGAIN: backlog drained. Anything else (e.g. EMFILE) is
+                // retried on the next wakeup rather than taking the server down.
+                return;
+            }
+            if (!watch(fd, EPOLLIN, EPOLL_CTL_ADD)) {
+                ::close(fd);
+                continue;
+            }
+            clients[fd];
+        }
+    }
+
+    void dropClient(int fd) {
+        auto it = clients.find(fd);
+        if (it != clients.end()) {
+            wipe(it->second.in);
+            wipe(it->second.out);
+            clients.erase(it);
+        }
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+    }
+
+    void serviceClient(int fd, uint32_t events) {
+        auto it = clients.find(fd);
+        if (it == clients.end()) return;
+        Client& client = it->second;
+
+        if (events & EPOLLERR) {
+            dropClient(fd);
+            return;
+        }
+        if ((events & (EPOLLIN | EPOLLHUP)) && !client.peerClosed) {
+            char buffer[4096];
+            for (;;) {
+                ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+                if (got > 0) {
+                    client.in.insert(client.in.end(), buffer, buffer + got);
+                    if (client.in.size() > 64 * 1024) {
+                        dropClient(fd); // Flooding with requests we aren't reading
+                        return;
+                    }
+                    continue;
+                }
+                if (got == 0) {
+                    client.peerClosed = true;
+                    break;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    dropClient(fd);
+                    return;
+                }
+                if (errno != EINTR) break;
+            }
+        }
+        if (!handleRequests(client) || !flush(fd, client) || (client.peerClosed && client.out.empty())) {
+            dropClient(fd);
+        }
+    }
+
+    // Answer every complete request, as far as the output limit allows;
+    // false if a frame is malformed
+    bool handleRequests(Client& client) {
+        size_t consumed = 0;
+        while (client.in.size() - consumed >= FRAME_HEADER && client.out.size() < OUTPUT_HIGH_WATER) {
+            uint32_t bodySize = readU32(&client.in[consumed]);
+            if (bodySize != REQUEST_SIZE) return false;
+            if (client.in.size() - consumed < FRAME_HEADER + REQUEST_SIZE) break;
+
+            const unsigned char* body = reinterpret_cast<const unsigned char*>(&client.in[consumed + FRAME_HEADER]);
+            if (body[0] != SERVE_VERSION) return false;
+            uint8_t flags = body[1];
+            size_t length = (size_t(body[2]) << 8) | body[3];
+            uint32_t count = readU32(reinterpret_cast<const char*>(body + 4));
+            consumed += FRAME_HEADER + REQUEST_SIZE;
+
+            respond(client.out, flags, length ? length : defaultLength, count);
+        }
+        if (consumed > 0) {
+            pwgen::secureZero(client.in.data(), consumed);
+            client.in.erase(client.in.begin(), client.in.begin() + consumed);
+        }
+        return true;
+    }
+
+    void respond(pwgen::SecureBytes& out, uint8_t flags, size_t length, uint32_t count) {
+        // One response is built in one go, so cap its size here; the output
+        // limit between requests then bounds a client to twice this
+        bool sized = count >= 1 && count <= SERVE_MAX_COUNT &&
+                     size_t(count) * (length + 1) <= SERVE_MAX_RESPONSE;
+        Pool* pool = sized ? poolFor(flags, length) : nullptr;
+        if (!pool) {
+            appendU32(out, 4);
+            appendU32(out, static_cast<uint32_t>(PWGEN_EINVAL));
+            return;
+        }
+
+        // Reserve up front so the response is assembled without reallocating
+        size_t frameStart = out.size();
+        out.reserve(frameStart + 2 * FRAME_HEADER + size_t(count) * (length + 1));
+        appendU32(out, 0); // patched below
+        appendU32(out, PWGEN_OK);
+        bool useReadyPool = flags == 0 && length == defaultLength;
+        for (uint32_t i = 0; i < count; i++) {
+            size_t at = out.size();
+            out.resize(at + length);
+            if (useReadyPool && readyPool.take(defaultOptions, length, &out[at])) {
+                out.push_back('\n');
+                continue;
+            }
+
+            if (pool->next == pool->passwords.size()) {
+                int rc = refill(*pool);
+                if (rc != PWGEN_OK) {
+                    pwgen::secureZero(out.data() + frameStart, out.size() - frameStart);
+                    out.resize(frameStart);
+                    appendU32(out, 4);
+                    appendU32(out, static_cast<uint32_t>(rc));
+                    return;
+                }
+            }
+            memcpy(&out[at], pool->passwords.data() + pool->next, length);
+            out.push_back('\n');
+            pwgen::secureZero(pool->passwords.data() + pool->next, length);
+            pool->next += length;
+        }
+
+        uint32_t bodySize = static_cast<uint32_t>(out.size() - frameStart - FRAME_HEADER);
+        for (int i = 0; i < 4; i++) {
+            out[frameStart + i] = static_cast<char>(bodySize >> (24 - 8 * i));
+        }
+    }
+
+    // Pool for a policy and length, created on first use; nullptr if the
+    // request is invalid
+    Pool* poolFor(uint8_t flags, size_t length) {
+        if (length == 0 || length > SERVE_MAX_LENGTH) return nullptr;
+        uint32_t key = (uint32_t(flags) << 16) | static_cast<uint32_t>(length);
+        auto it = pools.find(key);
+        if (it != pools.end()) return it->second.get();
+
+        pwgen_options options = defaultOptions;
+        if (flags != 0) {
+            options.use_upper = (flags & SERVE_UPPER) != 0;
+            options.use_lower = (flags & SERVE_LOWER) != 0;
+            options.use_digits = (flags & SERVE_DIGITS) != 0;
+            options.use_special = (flags & SERVE_SPECIAL) != 0;
+            options.avoid_similar = (flags & SERVE_AVOID_SIMILAR) != 0;
+            options.enforce_minimum = (flags & SERVE_ENFORCE_MINIMUM) != 0;
+        }
+
+        std::unique_ptr<Pool> pool(new Pool());
+        pool->context = pwgen_ctx_new(&options);
+        if (!pool->context || length < pwgen_min_length(pool->context)) return nullptr;
+        pool->length = length;
+
+        // Bound the memory held by clients cycling through policies
+        if (pools.size() >= MAX_POOLS) {
+            pools.erase(pools.begin());
+        }
+        Pool* result = pool.get();
+        pools[key] = std::move(pool);
+        return result;
+    }
+
+    int refill(Pool& pool) {
+        size_t count = POOL_BYTES / pool.length;
+        if (count == 0) count = 1;
+        pool.passwords.resize(count * pool.length);
+        pool.next = 0;
+        int rc = pwgen_generate_batch(pool.context, pool.passwords.data(), count, pool.length, 0);
+        for (size_t i = 0; rc == PWGEN_OK && breachCorpus && i < count; i++) {
+            char* password = pool.passwords.data() + i * pool.length;
+            for (int attempt = 1; rc == PWGEN_OK && breachCorpus->contains(password, pool.length); attempt++) {
+                rc = attempt < pwgen::BREACH_MAX_RETRIES
+                    ? pwgen_generate(pool.context, password, pool.length) : PWGEN_EINVAL;
+            }
+        }
+        if (rc != PWGEN_OK) {
+            // Nothing of a failed batch may be handed out
+            pwgen::secureZero(pool.passwords.data(), pool.passwords.size());
+            pool.next = pool.passwords.size();
+        }
+        return rc;
+    }
+
+    // Write what the socket takes; false if the client is gone
+    bool flush(int fd, Client& client) {
+        while (client.sent < client.out.size()) {
+            ssize_t wrote = send(fd, client.out.data() + client.sent, client.out.size() - client.sent,
+                                 MSG_NOSIGNAL);
+            if (wrote < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                return false;
+            }
+            client.sent += static_cast<size_t>(wrote);
+        }
+
+        if (client.sent == client.out.size()) {
+            wipe(client.out);
+            client.sent = 0;
+            // Requests held back by the output limit
+            if (!client.in.empty()) {
+                if (!handleRequests(client)) return false;
+                if (!client.out.empty()) return flush(fd, client);
+            }
+        }
+
+        uint32_t wanted = client.peerClosed ? 0u : uint32_t(EPOLLIN);
+        if (client.sent < client.out.size()) wanted |= EPOLLOUT;
+        if (wanted != client.watching) {
+            client.watching = wanted;
+            return watch(fd, wanted, EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+};
+
+#endif // PWGEN_PASSWORD_SERVER_H
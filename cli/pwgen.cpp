@@ -1,6 +1,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <array>
 #include <random>
 #include <algorithm>
 #include <cmath>
@@ -10,6 +11,26 @@
 #include <chrono>
 #include <csignal>
 #include <atomic>  // Added missing header for std::atomic
+#include <memory>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "../libpwgen/breach.h"
+#include "../libpwgen/secure_memory.h"
+#include "../libpwgen/site_policy.h"
+#include "../libpwgen/secure_random.h"
+#include "../libpwgen/charset_kernel.h"
+#include "../libpwgen/pwgen.h"
+#include "../libpwgen/estimator.h"
+#include "../libpwgen/strength.h"
+#include "../libpwgen/startup_trace.h"
+#include "../libpwgen/unique_filter.h"
+#include "../libpwgen/wordlist.h"
 
 // Cross-platform clipboard support
 #ifdef _WIN32
@@ -19,131 +40,418 @@
 #include <cstring>
 #endif
 
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#endif
+
+// Native X11 selection owner (-DPWGEN_X11 -lX11), used before the shell-outs below
+#ifdef PWGEN_X11
+#include <poll.h>
+#include "x11_clipboard.h"
+#endif
+
 // Cross-platform clipboard functions
-void setClipboardText(const std::string& text) {
+void setClipboardText(const char* text, size_t length) {
 #ifdef _WIN32
     // Windows implementation
     if (!OpenClipboard(nullptr)) return;
     EmptyClipboard();
-    HGLOBAL hg = GlobalAlloc(GMEM_MOVEABLE, text.size() + 1);
+    HGLOBAL hg = GlobalAlloc(GMEM_MOVEABLE, length + 1);
     if (!hg) {
         CloseClipboard();
         return;
     }
-    memcpy(GlobalLock(hg), text.c_str(), text.size() + 1);
+    char* data = static_cast<char*>(GlobalLock(hg));
+    memcpy(data, text, length);
+    data[length] = '\0';
     GlobalUnlock(hg);
     SetClipboardData(CF_TEXT, hg);
     CloseClipboard();
     GlobalFree(hg);
 #else
-    // Unix/Linux/macOS implementation using xclip or pbcopy
+    // Unix/Linux/macOS implementation using pbcopy, wl-copy or xclip
     FILE* pipe;
 #ifdef __APPLE__
     pipe = popen("pbcopy", "w");
 #else
-    pipe = popen("xclip -selection clipboard", "w");
+    const char* wayland = getenv("WAYLAND_DISPLAY");
+    if (wayland && *wayland) {
+        pipe = popen(length == 0 ? "wl-copy --clear" : "wl-copy", "w");
+    } else {
+        pipe = popen("xclip -selection clipboard", "w");
+    }
 #endif
     if (pipe) {
-        fwrite(text.c_str(), sizeof(char), text.size(), pipe);
+        fwrite(text, sizeof(char), length, pipe);
         pclose(pipe);
     }
 #endif
 }
 
 void clearClipboard() {
-    setClipboardText("");
+    setClipboardText("", 0);
 }
 
+// Buffered, newline-delimited output for bulk generation.
+// Lines are packed into one large buffer and written with fwrite when it fills,
+// so there is no per-line flush as with std::endl.
+class BufferedWriter {
+private:
+    FILE* stream;
+    pwgen::SecureBytes buffer; // wiped when the writer is destroyed
+    size_t used = 0;
+    bool failed = false;
+
+public:
+    explicit BufferedWriter(FILE* out, size_t capacity = 1 << 20)
+        : stream(out), buffer(capacity) {}
+
+    ~BufferedWriter() {
+        flush();
+    }
+
+    // Append one line; returns false once the underlying stream has failed
+    bool writeLine(const char* data, size_t len) {
+        if (used + len + 1 > buffer.size() && !flush()) {
+            return false;
+        }
+        if (len + 1 > buffer.size()) {
+            // Line larger than the whole buffer, write it straight through
+            if (fwrite(data, 1, len, stream) != len || fputc('\n', stream) == EOF) {
+                failed = true;
+            }
+            return !failed;
+        }
+        memcpy(buffer.data() + used, data, len);
+        used += len;
+        buffer[used++] = '\n';
+        return true;
+    }
+
+    bool writeLine(const std::string& line) {
+        return writeLine(line.data(), line.size());
+    }
+
+    // Append an already newline-delimited block of lines
+    bool writeBlock(const char* data, size_t len) {
+        if (used + len > buffer.size() && !flush()) {
+            return false;
+        }
+        if (len > buffer.size()) {
+            if (fwrite(data, 1, len, stream) != len) {
+                failed = true;
+            }
+            return !failed;
+        }
+        memcpy(buffer.data() + used, data, len);
+        used += len;
+        return true;
+    }
+
+    bool flush() {
+        if (failed) return false;
+        if (used > 0) {
+            if (fwrite(buffer.data(), 1, used, stream) != used) {
+                failed = true;
+            }
+            used = 0;
+        }
+        if (!failed && fflush(stream) != 0) {
+            failed = true;
+        }
+        return !failed;
+    }
+};
+
+// Bounded single-producer/single-consumer queue of filled output chunks.
+// Each bulk worker owns one, so the writer can drain workers round-robin
+// and emit chunks in a deterministic order.
+class ChunkQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<pwgen::SecureBytes> chunks;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit ChunkQueue(size_t depth = 2) : capacity(depth) {}
+
+    // Blocks while full; returns false if the queue was closed
+    bool push(pwgen::SecureBytes&& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return closed || chunks.size() < capacity; });
+        if (closed) return false;
+        chunks.push_back(std::move(chunk));
+        changed.notify_all();
+        return true;
+    }
+
+    // Blocks while empty; returns false if the queue was closed and drained
+    bool pop(pwgen::SecureBytes& chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return closed || !chunks.empty(); });
+        if (chunks.empty()) return false;
+        chunk = std::move(chunks.front());
+        chunks.pop_front();
+        changed.notify_all();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        changed.notify_all();
+    }
+};
+
 // Signal handler for cleanup
 std::atomic<bool> g_running{true};  // Changed initialization syntax for better compatibility
 void signalHandler(int signal) {
     g_running = false;
 }
 
-class PasswordGenerator {
-private:
-    // Cryptographically secure random number generator
-    std::random_device rd;
-    std::mt19937_64 secureGenerator;
+#ifdef __linux__
+// Sleep until `seconds` have passed or SIGINT/SIGTERM arrives, waking only
+// for those: one poll() over a signalfd and a one-shot timerfd. `fd`, if not
+// -1, is watched too and `onReadable` called when it has input; returning
+// false from it ends the wait early. A signal clears g_running, as the
+// handler would, and one that came earlier ends the wait at once. Returns
+// false if the descriptors can't be set up.
+bool waitForTimeout(int seconds, int fd, const std::function<bool()>& onReadable) {
+    sigset_t mask, previous;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    if (pthread_sigmask(SIG_BLOCK, &mask, &previous) != 0) {
+        return false;
+    }
+    
+    int signalFd = signalfd(-1, &mask, SFD_CLOEXEC);
+    int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    struct itimerspec deadline;
+    memset(&deadline, 0, sizeof(deadline));
+    deadline.it_value.tv_sec = seconds;
     
-    // Character sets
-    const std::string UPPERCASE = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    const std::string LOWERCASE = "abcdefghijklmnopqrstuvwxyz";
-    const std::string DIGITS = "0123456789";
-    const std::string SPECIAL = "!@#$%^&*()-_=+[]{};:,.<>?/";
-    const std::string SIMILAR = "Il1O0";
+    bool ok = signalFd >= 0 && timerFd >= 0 && timerfd_settime(timerFd, 0, &deadline, nullptr) == 0;
     
+    // A signal that arrived before the mask went up was taken by the handler,
+    // not queued for the signalfd; don't wait out the timeout for it
+    while (ok && g_running) {
+        struct pollfd fds[3] = { { signalFd, POLLIN, 0 }, { timerFd, POLLIN, 0 }, { fd, POLLIN, 0 } };
+        if (poll(fds, 3, -1) < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            if (read(signalFd, &info, sizeof(info)) == sizeof(info)) {
+                g_running = false;
+            }
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        if (fds[2].revents && !onReadable()) {
+            break;
+        }
+    }
+    
+    if (signalFd >= 0) close(signalFd);
+    if (timerFd >= 0) close(timerFd);
+    pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+    return ok;
+}
+#endif
+
+#ifdef __linux__
+#include "password_server.h"
+#endif
+
+// Owns a libpwgen context
+struct ContextDeleter {
+    void operator()(pwgen_ctx* ctx) const { pwgen_free(ctx); }
+};
+typedef std::unique_ptr<pwgen_ctx, ContextDeleter> ContextPtr;
+
+class PasswordGenerator {
+private:
     // Default settings
     int length = 16;
-    bool useUpper = true;
-    bool useLower = true;
-    bool useDigits = true;
-    bool useSpecial = true;
-    bool enforceMinimum = true;
-    bool avoidSimilar = false;
+    bool lengthGiven = false; // -l was used; it wins over a policy's length
+    pwgen_options options; // all classes, enforce minimum, ChaCha20
     int clipboardTimeout = 0; // seconds, 0 = disabled
     bool showStrengthMeter = true; // Show strength meter by default
+    long long count = 1; // Number of passwords to generate
+    unsigned int threads = 0; // Bulk worker threads, 0 = hardware concurrency
+    std::string serveSocket; // --serve: Unix socket to answer requests on
+    int words = 0; // -w: passphrase of this many words, 0 = character password
+    std::string separator = "-"; // Between passphrase words
+    std::string wordlistPath; // --wordlist, empty = default lookup
+    pwgen::Wordlist customWordlist;
+    const pwgen::Wordlist* wordlist = nullptr; // Set by loadWordlist()
+    pwgen::RandomBackend backend = pwgen::RandomBackend::ChaCha20;
+    std::string breachPath; // --breach-list, empty = default lookup
+    bool breachCheck = true; // --no-breach-check turns screening off
+    bool unique = false; // --unique: no repeats within one bulk run
+    pwgen::BreachCorpus customBreach;
+    const pwgen::BreachCorpus* breachCorpus = nullptr; // Set by loadBreachCorpus(), null = no screening
+    pwgen::PolicySettings policySettings; // --policy files and rule options, in order
+    std::unique_ptr<pwgen::SitePolicy> sitePolicy; // Set by loadSitePolicy(), null = charset options only
+    
+    // libpwgen context: compiled charset policy plus a seeded random source.
+    // Rebuilt only when the options change.
+    ContextPtr context;
     
     // Initialize random generator with strong entropy
     void initSecureRandom() {
-        std::array<unsigned int, std::mt19937_64::state_size> seedData;
-        std::generate(seedData.begin(), seedData.end(), std::ref(rd));
-        std::seed_seq seq(seedData.begin(), seedData.end());
-        secureGenerator.seed(seq);
+        PWGEN_TRACE_SCOPE("initSecureRandom");
+        context.reset(pwgen_ctx_new(&options));
+        if (!context) {
+            throw std::runtime_error("failed to initialize the password generator");
+        }
     }
     
-    // Calculate password strength score (0-100)
-    int calculateStrength(const std::string& password) {
-        if (password.empty()) return 0;
-        
-        int score = 0;
-        
-        // Length contribution (up to 40 points)
-        score += std::min(40, static_cast<int>(password.length() * 2));
-        
-        // Character variety (up to 30 points)
-        bool hasLower = false, hasUpper = false, hasDigit = false, hasSpecial = false;
-        for (char ch : password) {
-            if (islower(ch)) hasLower = true;
-            else if (isupper(ch)) hasUpper = true;
-            else if (isdigit(ch)) hasDigit = true;
-            else hasSpecial = true;
+    pwgen_ctx* currentContext() {
+        if (!context) {
+            initSecureRandom();
         }
-        
-        int charTypes = (hasLower ? 1 : 0) + (hasUpper ? 1 : 0) + 
-                        (hasDigit ? 1 : 0) + (hasSpecial ? 1 : 0);
-        score += charTypes * 7.5;
-        
-        // Entropy approximation (up to 30 points)
-        double entropy = 0;
-        if (hasLower) entropy += 26;
-        if (hasUpper) entropy += 26;
-        if (hasDigit) entropy += 10;
-        if (hasSpecial) entropy += 33;
-        
-        entropy = log2(entropy) * password.length();
-        score += std::min(30.0, entropy / 4.0);
-        
-        return std::min(100, score);
+        return context.get();
     }
     
-    // Get strength description based on score
-    std::string getStrengthDescription(int score) {
-        if (score < 30) return "Very Weak";
-        if (score < 50) return "Weak";
-        if (score < 70) return "Moderate";
-        if (score < 90) return "Strong";
-        return "Very Strong";
+    // Raise the length if it can't hold one character of each required type
+    void ensureMinimumLength() {
+        int minLength = static_cast<int>(pwgen_min_length(currentContext()));
+        if (length < minLength) {
+            length = minLength;
+            std::cerr << "Password length increased to " << length 
+                      << " to accommodate minimum character requirements." << std::endl;
+        }
     }
-
+    
+    // --seed: every output is a function of the seed and its index
+    bool seeded() const {
+        return backend == pwgen::RandomBackend::Seeded;
+    }
+    
+    // Worker count for bulk mode, never more than there are chunks to fill
+    unsigned int workerCount(long long chunks) const {
+        unsigned int workers = threads;
+        if (seeded() && unique) {
+            // Which copy of a duplicate gets redrawn depends on which thread
+            // inserts first; one worker keeps seeded output reproducible
+            return 1;
+        }
+        if (workers == 0) {
+            workers = std::thread::hardware_concurrency();
+            if (workers == 0) workers = 1;
+        }
+        if (static_cast<long long>(workers) > chunks) {
+            workers = static_cast<unsigned int>(chunks);
+        }
+        return workers;
+    }
+    
+    // Is this candidate in the breached-password corpus?
+    bool breached(const char* data, size_t size) const {
+        return breachCorpus && breachCorpus->contains(data, size);
+    }
+    
+    // Bulk mode's check on each output: not breached and, with --unique, not
+    // produced before. Counts each kind of rejection.
+    bool acceptable(const char* data, size_t size, pwgen::UniqueFilter* seen,
+                    std::atomic<long long>& breachedCount, std::atomic<long long>& duplicates) const {
+        if (breached(data, size)) {
+            breachedCount++;
+            return false;
+        }
+        if (seen && !seen->insert(data, size)) {
+            duplicates++;
+            return false;
+        }
+        return true;
+    }
+    
+    // A fraction as a percentage, readable however small
+    static std::string formatRate(double fraction) {
+        std::ostringstream text;
+        double percent = fraction * 100.0;
+        if (percent == 0.0 || percent >= 0.001) {
+            text << std::fixed << std::setprecision(4) << percent << "%";
+        } else {
+            text << std::scientific << std::setprecision(2) << percent << "%";
+        }
+        return text.str();
+    }
+    
+    // Draw bulk output `index` again after a rejection, from its `attempt`-th
+    // alternative when seeded
+    bool redraw(pwgen_ctx* worker, pwgen::SitePolicyGenerator* ruled, char* slot,
+                long long index, int attempt) const {
+        if (ruled) {
+            ruled->seek(static_cast<uint64_t>(index), static_cast<uint32_t>(attempt));
+            ruled->generate(slot);
+            return true;
+        }
+        if (seeded()) {
+            pwgen_seek(worker, static_cast<unsigned long long>(index), static_cast<unsigned int>(attempt));
+        }
+        return pwgen_generate(worker, slot, static_cast<size_t>(length)) == PWGEN_OK;
+    }
+    
+    // One password or passphrase, not yet screened. With --seed, `attempt`
+    // picks the redraw of output 0 so that screening stays reproducible.
+    pwgen::SecureBytes generateCandidate(unsigned int attempt) {
+        if (words > 0) {
+            pwgen::PassphraseGenerator phrases(*wordlist, backend, options.seed);
+            phrases.seek(0, attempt);
+            return phrases.generate(static_cast<size_t>(words), separator);
+        }
+        if (sitePolicy) {
+            pwgen::SitePolicyGenerator ruled(*sitePolicy, backend, options.seed);
+            ruled.seek(0, attempt);
+            pwgen::SecureBytes password(length);
+            ruled.generate(password.data());
+            return password;
+        }
+        if (seeded()) {
+            pwgen_seek(currentContext(), 0, attempt);
+        }
+        pwgen::SecureBytes password(length);
+        int rc = pwgen_generate(currentContext(), password.data(), password.size());
+        if (rc != PWGEN_OK) {
+            throw std::runtime_error(pwgen_strerror(rc));
+        }
+        return password;
+    }
+    
+    // Entropy of one password or passphrase under the current settings
+    double entropyBits() {
+        if (words > 0) {
+            return words * std::log2(static_cast<double>(wordlist->wordCount()));
+        }
+        if (sitePolicy) {
+            return sitePolicy->entropyBits();
+        }
+        return pwgen_entropy_bits(currentContext(), static_cast<size_t>(length));
+    }
+    
 public:
     PasswordGenerator() {
+        pwgen_options_init(&options);
         initSecureRandom();
     }
     
     // Setters for configuration
     void setLength(int value) { 
         length = value; 
+        lengthGiven = true;
     }
     
     void setClipboardTimeout(int value) { 
@@ -151,103 +459,240 @@ public:
     }
     
     void setCharSets(bool upper, bool lower, bool digits, bool special) {
-        useUpper = upper;
-        useLower = lower;
-        useDigits = digits;
-        useSpecial = special;
+        options.use_upper = upper;
+        options.use_lower = lower;
+        options.use_digits = digits;
+        options.use_special = special;
         
         // Ensure at least one character set is enabled
-        if (!useUpper && !useLower && !useDigits && !useSpecial) {
-            useLower = true;
+        if (!upper && !lower && !digits && !special) {
+            options.use_lower = true;
         }
+        context.reset();
     }
     
     void setSpecialChars(bool enabled) { 
-        useSpecial = enabled; 
+        options.use_special = enabled; 
+        context.reset();
     }
     
     void setAvoidSimilar(bool enabled) { 
-        avoidSimilar = enabled; 
+        options.avoid_similar = enabled; 
+        context.reset();
     }
     
     void setEnforceMinimum(bool enabled) { 
-        enforceMinimum = enabled; 
+        options.enforce_minimum = enabled; 
+        context.reset();
     }
     
     void setShowStrengthMeter(bool enabled) { 
         showStrengthMeter = enabled; 
     }
     
-    // Generate a secure password based on current settings
-    std::string generate() {
-        // Filter character sets based on settings
-        std::string chars;
-        
-        // Apply the "avoid similar" filter if needed
-        std::string upperChars = UPPERCASE;
-        std::string lowerChars = LOWERCASE;
-        std::string digitChars = DIGITS;
-        
-        if (avoidSimilar) {
-            for (char c : SIMILAR) {
-                upperChars.erase(std::remove(upperChars.begin(), upperChars.end(), c), upperChars.end());
-                lowerChars.erase(std::remove(lowerChars.begin(), lowerChars.end(), c), lowerChars.end());
-                digitChars.erase(std::remove(digitChars.begin(), digitChars.end(), c), digitChars.end());
+    void setCount(long long value) { 
+        count = value; 
+    }
+    
+    long long getCount() const { 
+        return count; 
+    }
+    
+    void setThreads(unsigned int value) { 
+        threads = value; 
+    }
+    
+    void setServeSocket(const std::string& path) { 
+        serveSocket = path; 
+    }
+    
+    bool isServing() const { 
+        return !serveSocket.empty(); 
+    }
+    
+    void setWords(int value) { 
+        words = value; 
+    }
+    
+    void setSeparator(const std::string& value) { 
+        separator = value; 
+    }
+    
+    void setWordlistPath(const std::string& path) { 
+        wordlistPath = path; 
+    }
+    
+    // Map the passphrase wordlist if -w was given; false (with a message) if
+    // there is none to use
+    bool loadWordlist() {
+        if (words <= 0) {
+            return true;
+        }
+        if (!wordlistPath.empty()) {
+            if (!customWordlist.open(wordlistPath)) {
+                std::cerr << "Error: " << wordlistPath << " is not a compiled wordlist (see pwwordsc)." << std::endl;
+                return false;
             }
+            wordlist = &customWordlist;
+            return true;
         }
+        wordlist = &pwgen::defaultWordlist();
+        if (wordlist->empty()) {
+            std::cerr << "Error: No passphrase wordlist found. Compile one with pwwordsc and pass it with"
+                      << " --wordlist, set PWGEN_WORDS, or install pwgen.words." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    void setBreachPath(const std::string& path) { 
+        breachPath = path; 
+    }
+    
+    void setBreachCheck(bool enabled) { 
+        breachCheck = enabled; 
+    }
+    
+    void setUnique(bool enabled) { 
+        unique = enabled; 
+    }
+    
+    // Add site-policy rules from a file; false (with a message) if it can't
+    // be read or has a bad line
+    bool addPolicyFile(const std::string& path) {
+        std::string error;
+        if (!pwgen::readPolicyFile(path, policySettings, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Add one site-policy rule given as an option (--digits 2-4, ...)
+    bool addPolicyRule(const std::string& key, const std::string& value) {
+        pwgen::PolicyRules scratch;
+        std::string error;
+        if (!pwgen::applyPolicySetting(scratch, key, value, error)) {
+            std::cerr << "Error: --" << error << std::endl;
+            return false;
+        }
+        policySettings.push_back(std::make_pair(key, value));
+        return true;
+    }
+    
+    // Compile the site-policy rules, if any, over the charset options for
+    // the final length; false (with a message) if no password satisfies them
+    bool loadSitePolicy() {
+        if (policySettings.empty()) {
+            return true;
+        }
+        if (words > 0 || isServing()) {
+            std::cerr << "Warning: Site-policy rules ignored " 
+                      << (words > 0 ? "for passphrases." : "in --serve mode.") << std::endl;
+            return true;
+        }
+        pwgen::CharsetOptions charset;
+        charset.useUpper = options.use_upper != 0;
+        charset.useLower = options.use_lower != 0;
+        charset.useDigits = options.use_digits != 0;
+        charset.useSpecial = options.use_special != 0;
+        charset.enforceMinimum = options.enforce_minimum != 0;
+        charset.avoidSimilar = options.avoid_similar != 0;
         
-        if (useUpper) chars += upperChars;
-        if (useLower) chars += lowerChars;
-        if (useDigits) chars += digitChars;
-        if (useSpecial) chars += SPECIAL;
-        
-        std::string password;
-        
-        if (enforceMinimum) {
-            // Calculate minimum length needed
-            int minLength = 0;
-            if (useUpper) minLength++;
-            if (useLower) minLength++;
-            if (useDigits) minLength++;
-            if (useSpecial) minLength++;
-            
-            if (length < minLength) {
-                length = minLength;
-                std::cerr << "Password length increased to " << length 
-                          << " to accommodate minimum character requirements." << std::endl;
-            }
-            
-            // Add one of each required type
-            if (useUpper) {
-                std::uniform_int_distribution<int> dist(0, upperChars.length() - 1);
-                password += upperChars[dist(secureGenerator)];
-            }
-            
-            if (useLower) {
-                std::uniform_int_distribution<int> dist(0, lowerChars.length() - 1);
-                password += lowerChars[dist(secureGenerator)];
-            }
-            
-            if (useDigits) {
-                std::uniform_int_distribution<int> dist(0, digitChars.length() - 1);
-                password += digitChars[dist(secureGenerator)];
-            }
-            
-            if (useSpecial) {
-                std::uniform_int_distribution<int> dist(0, SPECIAL.length() - 1);
-                password += SPECIAL[dist(secureGenerator)];
+        pwgen::PolicyRules rules = pwgen::policyRulesFrom(charset);
+        std::string error;
+        if (!pwgen::applyPolicySettings(rules, policySettings, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return false;
+        }
+        if (rules.length > 0 && !lengthGiven) {
+            length = rules.length;
+        }
+        try {
+            sitePolicy.reset(new pwgen::SitePolicy(rules, static_cast<size_t>(length)));
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Error: Site policy: " << e.what() << "." << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Map the breached-password corpus. Screening is silently skipped if no
+    // corpus is installed; false (with a message) only if --breach-list
+    // names one that can't be used.
+    bool loadBreachCorpus() {
+        if (!breachCheck) {
+            return true;
+        }
+        if (!breachPath.empty()) {
+            if (!customBreach.open(breachPath)) {
+                std::cerr << "Error: " << breachPath << " is not a compiled breach corpus (see pwbreachc)." << std::endl;
+                return false;
             }
+            breachCorpus = &customBreach;
+            return true;
         }
-        
-        // Fill the rest randomly
-        std::uniform_int_distribution<int> dist(0, chars.length() - 1);
-        while (password.length() < length) {
-            password += chars[dist(secureGenerator)];
+        const pwgen::BreachCorpus& corpus = pwgen::defaultBreachCorpus();
+        if (!corpus.empty()) {
+            breachCorpus = &corpus;
+        }
+        return true;
+    }
+    
+    void setRandomBackend(pwgen::RandomBackend value) { 
+        backend = value;
+        if (backend == pwgen::RandomBackend::Mt19937) {
+            std::cerr << "Warning: mt19937 is not cryptographically secure; use it for comparison only." << std::endl;
+        }
+        switch (backend) {
+            case pwgen::RandomBackend::System: options.rng = PWGEN_RNG_SYSTEM; break;
+            case pwgen::RandomBackend::Mt19937: options.rng = PWGEN_RNG_MT19937; break;
+            case pwgen::RandomBackend::ChaCha20: options.rng = PWGEN_RNG_CHACHA20; break;
+            case pwgen::RandomBackend::Seeded: options.rng = PWGEN_RNG_SEEDED; break;
+        }
+        context.reset();
+    }
+    
+    // Reproducible output for tests and benchmarks: counter-based ChaCha20
+    // keyed by `seed` (see pwgen::SeededRandom)
+    void setSeed(unsigned long long seed) { 
+        std::cerr << "Warning: --seed makes every password predictable from the seed;"
+                  << " use it for tests and benchmarks only, never for real credentials." << std::endl;
+        options.seed = seed;
+        setRandomBackend(pwgen::RandomBackend::Seeded);
+    }
+    
+    // Report the sustained output rate of every RNG backend
+    static void showRandomBenchmark() {
+        const pwgen::RandomBackend backends[] = {
+            pwgen::RandomBackend::System,
+            pwgen::RandomBackend::ChaCha20,
+            pwgen::RandomBackend::Mt19937
+        };
+        for (pwgen::RandomBackend backend : backends) {
+            std::unique_ptr<pwgen::RandomSource> source = pwgen::makeRandomSource(backend);
+            double rate = pwgen::measureThroughput(*source);
+            std::cout << std::left << std::setw(10) << source->name()
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << rate / (1024.0 * 1024.0) << " MiB/s" << std::endl;
+        }
+        std::cout << "Charset kernel: " << pwgen::simdLevelName(pwgen::detectSimdLevel()) << std::endl;
+    }
+    
+    // Generate a secure password based on current settings, drawing again
+    // whenever the candidate is a known breached password
+    pwgen::SecureBytes generate() {
+        PWGEN_TRACE_SCOPE("generate");
+        if (words <= 0 && !sitePolicy) {
+            ensureMinimumLength();
+        }
+        pwgen::SecureBytes password = generateCandidate(0);
+        for (int attempt = 1; breached(password.data(), password.size()); attempt++) {
+            if (attempt >= pwgen::BREACH_MAX_RETRIES) {
+                throw std::runtime_error("every candidate was a breached password; use a longer length or more character types");
+            }
+            password = generateCandidate(static_cast<unsigned int>(attempt));
         }
-        
-        // Shuffle the result to avoid predictable positions
-        std::shuffle(password.begin(), password.end(), secureGenerator);
-        
         return password;
     }
     
@@ -266,11 +711,42 @@ public:
                   << "  -m           Don't enforce minimum character types" << std::endl
                   << "  -n           Disable password strength meter" << std::endl
                   << "  -a           Alphanumeric only (same as -s)" << std::endl
-                  << "  -h           Show this help message" << std::endl;
+                  << "  -N <count>   Generate <count> passwords, one per line (bulk mode)" << std::endl
+                  << "  -j <threads> Worker threads for bulk mode (default: all cores)" << std::endl
+                  << "  -w <words>   Generate a passphrase of <words> words instead (diceware)" << std::endl
+                  << "  --unique     Never repeat an output within one bulk (-N) run" << std::endl
+                  << "  -h           Show this help message" << std::endl
+                  << "  --rng <name> Random backend: chacha20 (default), getrandom, mt19937 (insecure)" << std::endl
+                  << "  --rng-bench  Report throughput of each random backend and exit" << std::endl
+                  << "  --seed <n>   Reproducible output from seed <n>, for tests only (INSECURE)" << std::endl
+                  << "  --wordlist <file>" << std::endl
+                  << "               Compiled passphrase wordlist (default: $PWGEN_WORDS, then pwgen.words)" << std::endl
+                  << "  --separator <text>" << std::endl
+                  << "               Text between passphrase words (default: -)" << std::endl
+                  << "  --policy <file>" << std::endl
+                  << "               Site-policy rules to satisfy, one \"key = value\" per line" << std::endl
+                  << "  --upper, --lower, --digits, --special <min-max>" << std::endl
+                  << "               How many of a class, e.g. --digits 2-4, --special 0, --upper 1-" << std::endl
+                  << "  --exclude <chars>" << std::endl
+                  << "               Never use these characters" << std::endl
+                  << "  --max-repeat <n>" << std::endl
+                  << "               At most <n> identical characters in a row" << std::endl
+                  << "  --start <classes>" << std::endl
+                  << "               Allowed first character: letter, upper, lower, digit, special" << std::endl
+                  << "  --breach-list <file>" << std::endl
+                  << "               Compiled breached-password corpus to screen against" << std::endl
+                  << "               (default: $PWGEN_BREACH, then pwgen.breach)" << std::endl
+                  << "  --no-breach-check" << std::endl
+                  << "               Don't screen generated passwords against the corpus" << std::endl
+                  << "  --serve <socket>" << std::endl
+                  << "               Serve passwords on a Unix socket until interrupted (Linux)" << std::endl
+                  << "  --startup-trace <file>" << std::endl
+                  << "               Write startup timings as Chrome trace JSON (needs a" << std::endl
+                  << "               build with -DPWGEN_STARTUP_TRACE)" << std::endl;
     }
     
     // Handle clipboard functionality with timeout
-    void handleClipboard(const std::string& password) {
+    void handleClipboard(const pwgen::SecureBytes& password) {
         if (clipboardTimeout <= 0) {
             return; // Clipboard feature disabled
         }
@@ -279,14 +755,44 @@ public:
         signal(SIGINT, signalHandler);
         signal(SIGTERM, signalHandler);
         
-        // Copy to clipboard
-        setClipboardText(password);
+        // Copy to clipboard: hold the X11 selection ourselves if we can,
+        // otherwise hand the text to an external tool
+#ifdef PWGEN_X11
+        X11Clipboard x11;
+        bool native = x11.open() && x11.own(password.data(), password.size());
+#else
+        bool native = false;
+#endif
+        if (!native) {
+            setClipboardText(password.data(), password.size());
+        }
         std::cout << "Password copied to clipboard. Will clear in " 
                   << clipboardTimeout << " seconds." << std::endl;
         
-        // Wait for timeout
+        // Wait for timeout, blocking until the deadline or a signal where we can
+#ifdef __linux__
+        int watchFd = -1;
+        std::function<bool()> serve = []() { return true; };
+#ifdef PWGEN_X11
+        if (native) {
+            // Serve paste requests while waiting; stop early if another
+            // client has taken the clipboard over
+            x11.processEvents();
+            watchFd = x11.fd();
+            serve = [&x11]() {
+                x11.processEvents();
+                return x11.isOwner();
+            };
+        }
+#endif
+        bool waited = waitForTimeout(clipboardTimeout, watchFd, serve);
+#else
+        bool waited = false;
+#endif
+        
+        // Fallback: check the clock and g_running every 100 ms
         auto startTime = std::chrono::steady_clock::now();
-        while (g_running) {
+        while (!waited && g_running) {
             auto now = std::chrono::steady_clock::now();
             auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count();
             
@@ -294,26 +800,90 @@ public:
                 break;
             }
             
+#ifdef PWGEN_X11
+            if (native) {
+                struct pollfd pfd = { x11.fd(), POLLIN, 0 };
+                poll(&pfd, 1, 100);
+                x11.processEvents();
+                if (!x11.isOwner()) {
+                    break;
+                }
+                continue;
+            }
+#endif
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         
         // Clear clipboard
         if (g_running) {
+#ifdef PWGEN_X11
+            if (native) {
+                bool replaced = !x11.isOwner();
+                x11.release();
+                std::cout << (replaced ? "Clipboard replaced by another application." : "Clipboard cleared.")
+                          << std::endl;
+                return;
+            }
+#endif
             clearClipboard();
             std::cout << "Clipboard cleared." << std::endl;
         }
     }
     
+    // Daemon mode: answer requests on serveSocket until SIGINT/SIGTERM, using
+    // the command-line policy and length for requests that don't set their own
+    bool serve() {
+#ifdef __linux__
+        if (seeded()) {
+            std::cerr << "Error: --seed can't be used with --serve." << std::endl;
+            return false;
+        }
+        if (words > 0) {
+            std::cerr << "Warning: -w ignored in --serve mode; serving character passwords." << std::endl;
+        }
+        ensureMinimumLength();
+        
+        // Block SIGINT/SIGTERM before the server's pool thread starts, so it
+        // inherits the mask and run()'s signalfd is the only one to see them.
+        // Otherwise a signal can land on that thread and kill the process
+        // without removing the socket or wiping the pool.
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGINT);
+        sigaddset(&mask, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+        
+        PasswordServer server(options, static_cast<size_t>(length), breachCorpus);
+        if (!server.listen(serveSocket)) {
+            return false;
+        }
+        std::cerr << "Serving passwords on " << serveSocket << std::endl;
+        return server.run();
+#else
+        std::cerr << "Error: --serve is only supported on Linux." << std::endl;
+        return false;
+#endif
+    }
+    
     // Display password with strength info
-    void displayPassword(const std::string& password) {
+    void displayPassword(const pwgen::SecureBytes& password) {
         // Always show the password
-        std::cout << password << std::endl;
+        std::cout.write(password.data(), password.size());
+        std::cout << std::endl;
         
-        // Show strength meter if enabled
+        // Show strength meter if enabled. It is the policy's exact entropy,
+        // known without looking at the password; a pattern estimator would
+        // only see dictionary words in a passphrase and chance patterns in
+        // a random password.
         if (showStrengthMeter) {
-            int strength = calculateStrength(password);
-            std::string rating = getStrengthDescription(strength);
-            std::cout << "Strength: " << strength << "/100 (" << rating << ")" << std::endl;
+            double bits = entropyBits();
+            int strength = pwgen::scoreFromGuesses(bits * log10(2.0));
+            std::cout << "Entropy: " << std::fixed << std::setprecision(1) << bits << " bits";
+            if (words > 0) {
+                std::cout << " (" << words << " words from a " << wordlist->wordCount() << "-word list)";
+            }
+            std::cout << std::endl;
+            std::cout << "Strength: " << strength << "/100 (" << pwgen::strengthDescription(strength) << ")" << std::endl;
         }
         
         // Handle clipboard if timeout is set
@@ -321,15 +891,319 @@ public:
             handleClipboard(password);
         }
     }
+    
+    // Entropy and score of the current policy, known before generating anything.
+    // A random password costs an attacker about 2^entropy guesses.
+    void showPolicyStrength() {
+        double bits = entropyBits();
+        int strength = pwgen::scoreFromGuesses(bits * log10(2.0));
+        
+        std::cerr << "Entropy: " << std::fixed << std::setprecision(1) << bits
+                  << (words > 0 ? " bits per passphrase" : " bits per password") << std::endl;
+        std::cerr << "Strength: " << strength << "/100 ("
+                  << pwgen::strengthDescription(strength) << ")" << std::endl;
+    }
+    
+    // Bulk mode: write `count` passwords, one per line, through a buffered writer.
+    // The clipboard is a per-password feature and is skipped here; the strength
+    // meter is reported once, for the policy, on stderr (nothing is re-scanned).
+    //
+    // Passwords are produced in chunks of about 1 MiB. Chunk k is filled by
+    // worker k % workers, each with its own independently seeded engine, and the
+    // calling thread writes chunks back in order. Passphrases (-w) go through
+    // the same pipeline, with a PassphraseGenerator per worker.
+    //
+    // With --seed, output i is drawn from stream i of the seed (redraws from
+    // its numbered retries), so the result doesn't depend on -j.
+    //
+    // With --unique, every output is also recorded in a shared UniqueFilter
+    // and a repeat is redrawn in place, like a breached one.
+    bool writeBulk(BufferedWriter& out) {
+        PWGEN_TRACE_SCOPE("writeBulk");
+        
+        if (clipboardTimeout > 0) {
+            std::cerr << "Warning: Clipboard option ignored in bulk mode." << std::endl;
+        }
+        
+        if (words <= 0 && !sitePolicy) {
+            ensureMinimumLength();
+        }
+        
+        if (showStrengthMeter) {
+            showPolicyStrength();
+        }
+        
+        // Passphrase lines vary in length; size their chunks by the average
+        double lineSize = length + 1;
+        if (words > 0) {
+            lineSize = words * (wordlist->averageWordLength() + separator.size()) - separator.size() + 1;
+        }
+        const long long perChunk = std::max<long long>(1, static_cast<long long>((1 << 20) / lineSize));
+        
+        // --unique: refuse what the keyspace can't hold, then size the filter
+        std::unique_ptr<pwgen::UniqueFilter> seen;
+        double keyspaceBits = 0;
+        if (unique) {
+            keyspaceBits = entropyBits();
+            double keyspace = std::exp2(keyspaceBits);
+            if (keyspaceBits < 53) keyspace = std::round(keyspace);
+            if (static_cast<double>(count) > keyspace) {
+                std::cerr << "Error: --unique: this policy only has " << std::setprecision(0) << keyspace
+                          << " distinct outputs; ask for fewer or widen it." << std::endl;
+                return false;
+            }
+            if (static_cast<double>(count) > keyspace / 2) {
+                std::cerr << "Warning: --unique: asking for more than half the keyspace; redraws will slow the run down." << std::endl;
+            }
+            seen.reset(new pwgen::UniqueFilter(static_cast<uint64_t>(count)));
+        }
+        const int maxAttempts = seen ? pwgen::UNIQUE_MAX_RETRIES : pwgen::BREACH_MAX_RETRIES;
+        const long long chunks = (count + perChunk - 1) / perChunk;
+        const unsigned int workers = workerCount(chunks);
+        
+        std::vector<std::unique_ptr<ChunkQueue>> queues;
+        for (unsigned int w = 0; w < workers; w++) {
+            queues.emplace_back(new ChunkQueue());
+        }
+        
+        std::atomic<bool> generatorFailed{false};
+        std::atomic<long long> rejected{0};
+        std::atomic<long long> duplicates{0};
+        std::vector<std::thread> pool;
+        for (unsigned int w = 0; w < workers; w++) {
+            pool.emplace_back([this, w, workers, chunks, perChunk, maxAttempts, &seen, &queues,
+                               &generatorFailed, &rejected, &duplicates] {
+                // Each worker owns a context (or passphrase or site-policy
+                // generator), so each has its own seeded random source
+                ContextPtr worker;
+                std::unique_ptr<pwgen::PassphraseGenerator> phrases;
+                std::unique_ptr<pwgen::SitePolicyGenerator> ruled;
+                if (words > 0) {
+                    phrases.reset(new pwgen::PassphraseGenerator(*wordlist, backend, options.seed));
+                } else if (sitePolicy) {
+                    ruled.reset(new pwgen::SitePolicyGenerator(*sitePolicy, backend, options.seed));
+                } else {
+                    worker.reset(pwgen_ctx_new(&options));
+                }
+                if (!worker && !phrases && !ruled) {
+                    generatorFailed = true;
+                    queues[w]->close();
+                    return;
+                }
+                
+                for (long long chunk = w; chunk < chunks; chunk += workers) {
+                    long long first = chunk * perChunk;
+                    long long n = std::min(perChunk, count - first);
+                    
+                    // One contiguous, newline-delimited block per chunk
+                    if (phrases) {
+                        pwgen::SecureBytes block;
+                        block.reserve(static_cast<size_t>(n) * (phrases->maxLength(words, separator) + 1));
+                        for (long long i = 0; i < n; i++) {
+                            size_t start = block.size();
+                            phrases->seek(static_cast<uint64_t>(first + i));
+                            phrases->append(static_cast<size_t>(words), separator, block);
+                            for (int attempt = 1; !acceptable(block.data() + start, block.size() - start,
+                                                              seen.get(), rejected, duplicates); attempt++) {
+                                if (attempt >= maxAttempts) {
+                                    generatorFailed = true;
+                                    queues[w]->close();
+                                    return;
+                                }
+                                block.resize(start);
+                                phrases->seek(static_cast<uint64_t>(first + i), static_cast<uint32_t>(attempt));
+                                phrases->append(static_cast<size_t>(words), separator, block);
+                            }
+                            block.push_back('\n');
+                        }
+                        if (!queues[w]->push(std::move(block))) {
+                            return; // Writer gave up
+                        }
+                        continue;
+                    }
+                    
+                    const size_t stride = static_cast<size_t>(length) + 1;
+                    pwgen::SecureBytes block(static_cast<size_t>(n) * stride, '\n');
+                    if (ruled) {
+                        // One exact draw per slot under the site policy
+                        for (long long i = 0; i < n; i++) {
+                            ruled->seek(static_cast<uint64_t>(first + i));
+                            ruled->generate(block.data() + static_cast<size_t>(i) * stride);
+                        }
+                    } else {
+                        if (seeded()) {
+                            pwgen_seek(worker.get(), static_cast<unsigned long long>(first), 0);
+                        }
+                        if (pwgen_generate_batch(worker.get(), block.data(), static_cast<size_t>(n),
+                                                 static_cast<size_t>(length), stride) != PWGEN_OK) {
+                            generatorFailed = true;
+                            queues[w]->close();
+                            return;
+                        }
+                    }
+                    
+                    // Screen every slot, redrawing breached ones and repeats in place
+                    if (breachCorpus || seen) {
+                        for (long long i = 0; i < n; i++) {
+                            char* slot = block.data() + static_cast<size_t>(i) * stride;
+                            for (int attempt = 1; !acceptable(slot, static_cast<size_t>(length),
+                                                              seen.get(), rejected, duplicates); attempt++) {
+                                if (attempt >= maxAttempts ||
+                                    !redraw(worker.get(), ruled.get(), slot, first + i, attempt)) {
+                                    generatorFailed = true;
+                                    queues[w]->close();
+                                    return;
+                                }
+                            }
+                        }
+                    }
+                    
+                    if (!queues[w]->push(std::move(block))) {
+                        return; // Writer gave up
+                    }
+                }
+                queues[w]->close();
+            });
+        }
+        
+        bool ok = true;
+        pwgen::SecureBytes block;
+        for (long long chunk = 0; chunk < chunks && ok; chunk++) {
+            if (!queues[chunk % workers]->pop(block) || !out.writeBlock(block.data(), block.size())) {
+                ok = false;
+            }
+        }
+        
+        // Release any workers still blocked on a full queue
+        for (auto& queue : queues) {
+            queue->close();
+        }
+        for (auto& worker : pool) {
+            worker.join();
+        }
+        
+        if (generatorFailed) {
+            std::cerr << "Error: Password generation failed." << std::endl;
+            return false;
+        }
+        if (rejected > 0 && showStrengthMeter) {
+            std::cerr << "Rejected " << rejected << " breached candidates." << std::endl;
+        }
+        if (seen) {
+            // Rates are per draw: redrawn duplicates over everything generated
+            double expected = pwgen::expectedDuplicates(keyspaceBits, static_cast<double>(count));
+            std::cerr << "Unique: " << count << (words > 0 ? " passphrases, " : " passwords, ")
+                      << duplicates << " duplicates redrawn (filter: "
+                      << (seen->memoryBytes() + (1 << 19)) / (1 << 20) << " MiB)" << std::endl;
+            std::cerr << "Collision rate: " << formatRate(duplicates / static_cast<double>(count + duplicates))
+                      << " observed, " << formatRate(expected / (count + expected))
+                      << " expected from a keyspace of 2^" << std::fixed << std::setprecision(1)
+                      << keyspaceBits << std::endl;
+        }
+        if (!ok || !out.flush()) {
+            std::cerr << "Error: Failed to write output." << std::endl;
+            return false;
+        }
+        return true;
+    }
 };
 
 // Custom command-line argument parser to handle errors better than getopt
 void parseCommandLine(int argc, char* argv[], PasswordGenerator& generator) {
+    PWGEN_TRACE_SCOPE("parseCommandLine");
+    
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
         
+        // Long options (--name [value])
+        if (arg.compare(0, 2, "--") == 0) {
+            if (arg == "--rng") {
+                pwgen::RandomBackend backend;
+                if (i + 1 < argc && pwgen::parseRandomBackend(argv[i+1], backend)) {
+                    generator.setRandomBackend(backend);
+                    i++;
+                } else {
+                    std::cerr << "Error: --rng requires one of chacha20, getrandom, mt19937. Using default." << std::endl;
+                }
+            } else if (arg == "--seed") {
+                try {
+                    if (i + 1 >= argc || argv[i+1][0] == '-') {
+                        throw std::invalid_argument("missing");
+                    }
+                    generator.setSeed(std::stoull(argv[++i], nullptr, 0));
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: --seed requires a numeric seed." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--rng-bench") {
+                PasswordGenerator::showRandomBenchmark();
+                exit(0);
+            } else if (arg == "--serve") {
+                if (i + 1 < argc) {
+                    generator.setServeSocket(argv[++i]);
+                } else {
+                    std::cerr << "Error: --serve requires a socket path." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--startup-trace") {
+                if (i + 1 < argc) {
+                    if (!pwgen::setStartupTraceOutput(argv[++i])) {
+                        std::cerr << "Warning: --startup-trace ignored, built without PWGEN_STARTUP_TRACE." << std::endl;
+                    }
+                } else {
+                    std::cerr << "Error: --startup-trace requires a file name." << std::endl;
+                }
+            } else if (arg == "--wordlist") {
+                if (i + 1 < argc) {
+                    generator.setWordlistPath(argv[++i]);
+                } else {
+                    std::cerr << "Error: --wordlist requires a file name." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--separator") {
+                if (i + 1 < argc) {
+                    generator.setSeparator(argv[++i]);
+                } else {
+                    std::cerr << "Error: --separator requires a value." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--breach-list") {
+                if (i + 1 < argc) {
+                    generator.setBreachPath(argv[++i]);
+                } else {
+                    std::cerr << "Error: --breach-list requires a file name." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--policy") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: --policy requires a file name." << std::endl;
+                    exit(1);
+                }
+                if (!generator.addPolicyFile(argv[++i])) {
+                    exit(1);
+                }
+            } else if (arg == "--upper" || arg == "--lower" || arg == "--digits" || arg == "--special" ||
+                       arg == "--exclude" || arg == "--max-repeat" || arg == "--start") {
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: " << arg << " requires a value." << std::endl;
+                    exit(1);
+                }
+                if (!generator.addPolicyRule(arg.substr(2), argv[++i])) {
+                    exit(1);
+                }
+            } else if (arg == "--unique") {
+                generator.setUnique(true);
+            } else if (arg == "--no-breach-check") {
+                generator.setBreachCheck(false);
+            } else if (arg == "--help") {
+                generator.showHelp();
+                exit(0);
+            } else {
+                std::cerr << "Warning: Unknown option " << arg << " ignored." << std::endl;
+            }
+        }
         // Check if it's an option (starts with -)
-        if (arg[0] == '-') {
+        else if (arg[0] == '-') {
             // Single character options
             if (arg.length() == 2) {
                 char option = arg[1];
@@ -366,6 +1240,59 @@ void parseCommandLine(int argc, char* argv[], PasswordGenerator& generator) {
                         }
                         break;
                         
+                    case 'N': // bulk count
+                        if (i + 1 < argc && argv[i+1][0] != '-') {
+                            try {
+                                long long count = std::stoll(argv[++i]);
+                                if (count < 1) {
+                                    std::cerr << "Error: Count must be at least 1. Using 1." << std::endl;
+                                    count = 1;
+                                }
+                                generator.setCount(count);
+                            } catch (const std::exception& e) {
+                                std::cerr << "Error: Invalid count parameter. Generating a single password." << std::endl;
+                            }
+                        } else {
+                            std::cerr << "Error: -N option requires a numeric argument. Generating a single password." << std::endl;
+                        }
+                        break;
+                        
+                    case 'j': // bulk worker threads
+                        if (i + 1 < argc && argv[i+1][0] != '-') {
+                            try {
+                                int threads = std::stoi(argv[++i]);
+                                if (threads < 1) {
+                                    std::cerr << "Error: Thread count must be at least 1. Using 1." << std::endl;
+                                    threads = 1;
+                                }
+                                generator.setThreads(static_cast<unsigned int>(threads));
+                            } catch (const std::exception& e) {
+                                std::cerr << "Error: Invalid thread count. Using all cores." << std::endl;
+                            }
+                        } else {
+                            std::cerr << "Error: -j option requires a numeric argument. Using all cores." << std::endl;
+                        }
+                        break;
+                        
+                    case 'w': // passphrase words
+                        if (i + 1 < argc && argv[i+1][0] != '-') {
+                            try {
+                                int words = std::stoi(argv[++i]);
+                                if (words < 1 || words > 64) {
+                                    std::cerr << "Error: Word count must be between 1 and 64. Using 6." << std::endl;
+                                    words = 6;
+                                } else if (words < 4) {
+                                    std::cerr << "Warning: Passphrases of fewer than 4 words are not recommended." << std::endl;
+                                }
+                                generator.setWords(words);
+                            } catch (const std::exception& e) {
+                                std::cerr << "Error: Invalid word count. Generating a password instead." << std::endl;
+                            }
+                        } else {
+                            std::cerr << "Error: -w option requires a numeric argument. Generating a password instead." << std::endl;
+                        }
+                        break;
+                        
                     case 'u': // uppercase only
                         generator.setCharSets(true, false, false, false);
                         break;
@@ -437,7 +1364,10 @@ void parseCommandLine(int argc, char* argv[], PasswordGenerator& generator) {
                             break;
                         case 'l': 
                         case 'p': 
-                            std::cerr << "Warning: Options -l and -p require values and cannot be grouped." << std::endl;
+                        case 'N': 
+                        case 'j': 
+                        case 'w': 
+                            std::cerr << "Warning: Options -l, -p, -N, -j and -w require values and cannot be grouped." << std::endl;
                             break;
                         default:
                             std::cerr << "Warning: Unknown option -" << option << " ignored." << std::endl;
@@ -453,6 +1383,10 @@ void parseCommandLine(int argc, char* argv[], PasswordGenerator& generator) {
 }
 
 int main(int argc, char* argv[]) {
+    // Declared outside the try block so the trace is written on every return
+    PWGEN_TRACE_SESSION();
+    PWGEN_TRACE_SCOPE("main");
+    
     try {
         PasswordGenerator generator;
         
@@ -461,7 +1395,21 @@ int main(int argc, char* argv[]) {
             parseCommandLine(argc, argv, generator);
         }
         
-        std::string password = generator.generate();
+        if (!generator.loadWordlist() || !generator.loadBreachCorpus() || !generator.loadSitePolicy()) {
+            return 1;
+        }
+        
+        if (generator.isServing()) {
+            return generator.serve() ? 0 : 1;
+        }
+        
+        if (generator.getCount() > 1) {
+            // Bulk mode writes newline-delimited passwords only
+            BufferedWriter out(stdout);
+            return generator.writeBulk(out) ? 0 : 1;
+        }
+        
+        pwgen::SecureBytes password = generator.generate();
         generator.displayPassword(password);
         
         return 0;
@@ -0,0 +1,137 @@
+// Checks behind seeded_output.sh that need the library rather than the CLI:
+// with PWGEN_RNG_SEEDED, pwgen_seek(i) followed by one pwgen_generate() must
+// reproduce password i of a batch run, and retries must differ from it. And
+// every SIMD charset kernel this CPU runs must be bit-identical to the
+// scalar one on the same seeded stream.
+//
+//   g++ -O2 -std=c++11 -o seeded_check cli/tests/seeded_check.cpp libpwgen/pwgen.cpp -pthread
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../libpwgen/charset_kernel.h"
+#include "../../libpwgen/pwgen.h"
+#include "../../libpwgen/secure_random.h"
+
+static int failures = 0;
+
+static void fail(const char* what, unsigned long long index) {
+    fprintf(stderr, "FAIL: %s (index %llu)\n", what, index);
+    failures++;
+}
+
+static pwgen_ctx* seededContext(int enforceMinimum) {
+    pwgen_options options;
+    pwgen_options_init(&options);
+    options.rng = PWGEN_RNG_SEEDED;
+    options.seed = 42;
+    options.enforce_minimum = enforceMinimum;
+    return pwgen_ctx_new(&options);
+}
+
+// Password i of one long batch == seek(i) + generate on a fresh context
+static void checkSeek(int enforceMinimum, size_t length) {
+    const size_t count = 20000;
+    pwgen_ctx* batch = seededContext(enforceMinimum);
+    pwgen_ctx* single = seededContext(enforceMinimum);
+    if (!batch || !single) {
+        fail("seeded context", 0);
+        return;
+    }
+
+    std::vector<char> all(count * length);
+    pwgen_generate_batch(batch, all.data(), count, length, 0);
+
+    std::vector<char> one(length), retry(length);
+    for (unsigned long long i = 0; i < count; i += 997) {
+        pwgen_seek(single, i, 0);
+        pwgen_generate(single, one.data(), length);
+        if (memcmp(one.data(), &all[i * length], length) != 0) {
+            fail("pwgen_seek(i) doesn't reproduce password i", i);
+        }
+        pwgen_seek(single, i, 1);
+        pwgen_generate(single, retry.data(), length);
+        if (memcmp(retry.data(), one.data(), length) == 0) {
+            fail("retry 1 repeats retry 0", i);
+        }
+    }
+
+    // Seeking back to an index gives the same password again
+    pwgen_seek(single, 12345, 0);
+    pwgen_generate(single, one.data(), length);
+    if (memcmp(one.data(), &all[12345 * length], length) != 0) {
+        fail("seeking back", 12345);
+    }
+
+    pwgen_free(batch);
+    pwgen_free(single);
+}
+
+// `level` against the scalar kernel for an alphabet of `size` characters:
+// sample() from two identically seeded sources, and map() over one buffer
+// with every capacity limit up to a few vectors, which must agree on both
+// the characters and the bytes consumed
+static void checkKernel(pwgen::SimdLevel level, size_t size) {
+    std::string alphabet;
+    for (size_t i = 0; i < size; i++) {
+        alphabet += static_cast<char>(' ' + 1 + i);
+    }
+    pwgen::CharsetKernel scalar(alphabet, pwgen::SimdLevel::Scalar);
+    pwgen::CharsetKernel simd(alphabet, level);
+
+    const size_t counts[] = { 1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1000, 65536 };
+    for (size_t count : counts) {
+        pwgen::SeededRandom a(42), b(42);
+        a.beginPassword();
+        b.beginPassword();
+        std::vector<char> want(count), got(count);
+        scalar.sample(a, want.data(), count);
+        simd.sample(b, got.data(), count);
+        if (want != got) {
+            fprintf(stderr, "FAIL: %s kernel, %zu-character alphabet: sample(%zu) differs from scalar\n",
+                    pwgen::simdLevelName(level), size, count);
+            failures++;
+        }
+    }
+
+    pwgen::SeededRandom source(7);
+    source.beginPassword();
+    std::vector<uint8_t> bytes(4096);
+    source.fill(bytes.data(), bytes.size());
+    for (size_t capacity = 0; capacity <= 200; capacity++) {
+        std::vector<char> want(capacity + 1, 0), got(capacity + 1, 0);
+        size_t wantConsumed = 0, gotConsumed = 0;
+        size_t wantCount = scalar.map(bytes.data(), bytes.size(), want.data(), capacity, wantConsumed);
+        size_t gotCount = simd.map(bytes.data(), bytes.size(), got.data(), capacity, gotConsumed);
+        if (wantCount != gotCount || wantConsumed != gotConsumed || want != got) {
+            fprintf(stderr, "FAIL: %s kernel, %zu-character alphabet: map() with capacity %zu differs from scalar\n",
+                    pwgen::simdLevelName(level), size, capacity);
+            failures++;
+            return;
+        }
+    }
+}
+
+int main() {
+    checkSeek(1, 16);
+    checkSeek(0, 16);
+    checkSeek(1, 200);   // more than one keystream block per password
+
+    // Sizes around the kernels' power-of-two and rejection-threshold edges
+    const size_t sizes[] = { 10, 16, 17, 62, 64 };
+    const pwgen::SimdLevel levels[] = { pwgen::SimdLevel::SSE41, pwgen::SimdLevel::AVX2 };
+    for (pwgen::SimdLevel level : levels) {
+        if (static_cast<int>(level) > static_cast<int>(pwgen::detectSimdLevel())) {
+            printf("SKIP: %s kernel (not supported on this CPU)\n", pwgen::simdLevelName(level));
+            continue;
+        }
+        for (size_t size : sizes) {
+            checkKernel(level, size);
+        }
+    }
+
+    if (failures == 0) printf("PASS: seeded_check\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#!/bin/sh
+# `pwgen --serve` must refuse a request whose response would exceed
+# SERVE_MAX_RESPONSE (count * (length + 1) > 4 MiB) with PWGEN_EINVAL,
+# without building it, and keep serving the same connection afterwards.
+#
+#   cli/tests/serve_limits.sh [path/to/pwgen]
+#
+# Needs python3 for the protocol client.
+
+PWGEN=${1:-$(dirname "$0")/../pwgen}
+if ! command -v python3 >/dev/null 2>&1; then
+    echo "SKIP: serve_limits (no python3)"
+    exit 0
+fi
+DIR=$(mktemp -d) || exit 1
+sock="$DIR/pwgen.sock"
+"$PWGEN" --serve "$sock" 2>/dev/null &
+pid=$!
+trap 'kill "$pid" 2>/dev/null; wait "$pid" 2>/dev/null; rm -rf "$DIR"' EXIT
+
+tries=0
+while [ ! -S "$sock" ] && [ $tries -lt 50 ]; do
+    sleep 0.1
+    tries=$((tries + 1))
+done
+
+python3 - "$sock" <<'PY'
+import socket, struct, sys
+
+s = socket.socket(socket.AF_UNIX)
+s.connect(sys.argv[1])
+
+def recv_exactly(n):
+    data = b""
+    while len(data) < n:
+        chunk = s.recv(n - len(data))
+        if not chunk:
+            sys.exit("FAIL: server closed the connection")
+        data += chunk
+    return data
+
+def request(length, count):
+    s.sendall(struct.pack(">IBBHI", 8, 1, 0, length, count))
+    size = struct.unpack(">I", recv_exactly(4))[0]
+    body = recv_exactly(size)
+    return struct.unpack(">i", body[:4])[0], size
+
+EINVAL = -1
+cases = [
+    # (length, count, expected status, why)
+    (1024, 100000, EINVAL, "~100 MB response"),
+    (1024, 4093, EINVAL, "just over 4 MiB"),
+    (1024, 4092, 0, "just under 4 MiB"),
+    (20, 5, 0, "small request after refusals"),
+    (0, 100000, 0, "default length, maximum count"),
+]
+failed = False
+for length, count, expected, why in cases:
+    status, size = request(length, count)
+    if status != expected:
+        print("FAIL: length %d count %d (%s): status %d, expected %d" % (length, count, why, status, expected))
+        failed = True
+    elif status == EINVAL and size != 4:
+        print("FAIL: length %d count %d: refusal carried %d bytes" % (length, count, size))
+        failed = True
+sys.exit(1 if failed else 0)
+PY
+status=$?
+[ $status -eq 0 ] && echo "PASS: serve_limits"
+exit $status
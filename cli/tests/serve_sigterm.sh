@@ -0,0 +1,41 @@
+#!/bin/sh
+# `pwgen --serve` must shut down cleanly on SIGTERM and SIGINT: exit 0 and
+# remove its socket, whichever thread the signal would have been sent to.
+#
+#   cli/tests/serve_sigterm.sh [path/to/pwgen]
+
+PWGEN=${1:-$(dirname "$0")/../pwgen}
+DIR=$(mktemp -d) || exit 1
+trap 'rm -rf "$DIR"' EXIT
+failed=0
+
+for sig in TERM INT; do
+    for run in 1 2 3 4 5; do
+        sock="$DIR/pwgen-$sig-$run.sock"
+        "$PWGEN" --serve "$sock" 2>/dev/null &
+        pid=$!
+
+        # Wait for the socket, then give the pool thread time to start
+        tries=0
+        while [ ! -S "$sock" ] && [ $tries -lt 50 ]; do
+            sleep 0.1
+            tries=$((tries + 1))
+        done
+        sleep 0.2
+
+        kill -s "$sig" "$pid"
+        wait "$pid"
+        status=$?
+        if [ $status -ne 0 ]; then
+            echo "FAIL: SIG$sig run $run: exit status $status, expected 0"
+            failed=1
+        fi
+        if [ -e "$sock" ]; then
+            echo "FAIL: SIG$sig run $run: socket $sock left behind"
+            failed=1
+        fi
+    done
+done
+
+[ $failed -eq 0 ] && echo "PASS: serve_sigterm"
+exit $failed
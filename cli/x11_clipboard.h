@@ -0,0 +1,173 @@
+#ifndef PWGEN_X11_CLIPBOARD_H
+#define PWGEN_X11_CLIPBOARD_H
+
+// In-process owner of the X11 CLIPBOARD selection.
+//
+// X11 has no clipboard server: whoever owns the selection answers every paste
+// request itself. xclip does this by forking a daemon per copy; here the pwgen
+// process is the owner for as long as the -p timeout runs, answering requests
+// from its wait loop, and gives the selection up (wiping its copy) on timeout.
+//
+// The contents are UTF-8 (passphrases from a UTF-8 wordlist may not be ASCII)
+// and are served unchanged as UTF8_STRING, which TEXT also resolves to.
+// STRING is Latin-1 by definition, so it is only offered for ASCII contents;
+// clients asking for it otherwise are refused and fall back to UTF8_STRING.
+//
+// Only built with -DPWGEN_X11 (link with -lX11).
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+#include <cstddef>
+
+#include "../libpwgen/secure_memory.h"
+
+class X11Clipboard {
+public:
+    X11Clipboard() {}
+
+    ~X11Clipboard() {
+        release();
+        if (display) {
+            XDestroyWindow(display, window);
+            XCloseDisplay(display);
+        }
+    }
+
+    // Connect to $DISPLAY; false if there is no X server to talk to
+    bool open() {
+        if (display) return true;
+        display = XOpenDisplay(nullptr);
+        if (!display) return false;
+
+        window = XCreateSimpleWindow(display, DefaultRootWindow(display), 0, 0, 1, 1, 0, 0, 0);
+        XSelectInput(display, window, PropertyChangeMask);
+        clipboardAtom = XInternAtom(display, "CLIPBOARD", False);
+        targetsAtom = XInternAtom(display, "TARGETS", False);
+        utf8Atom = XInternAtom(display, "UTF8_STRING", False);
+        textAtom = XInternAtom(display, "TEXT", False);
+        mimeAtom = XInternAtom(display, "text/plain;charset=utf-8", False);
+        timestampAtom = XInternAtom(display, "PWGEN_TIMESTAMP", False);
+        return true;
+    }
+
+    // Take the selection; false if the X server didn't give it to us
+    bool own(const char* text, size_t length) {
+        if (!display) return false;
+        release();
+        contents.assign(text, text + length);
+        ownedSince = serverTime();
+        XSetSelectionOwner(display, clipboardAtom, window, ownedSince);
+        owned = XGetSelectionOwner(display, clipboardAtom) == window;
+        XFlush(display);
+        if (!owned) wipe();
+        return owned;
+    }
+
+    // Give the selection up if we still hold it, and forget the text
+    void release() {
+        if (owned) {
+            XSetSelectionOwner(display, clipboardAtom, None, ownedSince);
+            XFlush(display);
+            owned = false;
+        }
+        wipe();
+    }
+
+    // Still the owner? Another client copying something takes it from us.
+    bool isOwner() const { return owned; }
+
+    // Connection socket, readable when requests are waiting
+    int fd() const { return display ? ConnectionNumber(display) : -1; }
+
+    // Answer every queued paste request without blocking
+    void processEvents() {
+        if (!display) return;
+        while (XPending(display) > 0) {
+            XEvent event;
+            XNextEvent(display, &event);
+            if (event.type == SelectionRequest) {
+                answer(event.xselectionrequest);
+            } else if (event.type == SelectionClear && event.xselectionclear.selection == clipboardAtom) {
+                owned = false;
+                wipe();
+            }
+        }
+    }
+
+private:
+    Display* display = nullptr;
+    Window window = 0;
+    Atom clipboardAtom = None;
+    Atom targetsAtom = None;
+    Atom utf8Atom = None;
+    Atom textAtom = None;
+    Atom mimeAtom = None;
+    Atom timestampAtom = None;
+    Time ownedSince = CurrentTime;
+    bool owned = false;
+    pwgen::SecureBytes contents;   // wiped by the arena when released
+
+    X11Clipboard(const X11Clipboard&);
+    X11Clipboard& operator=(const X11Clipboard&);
+
+    void wipe() {
+        pwgen::SecureBytes().swap(contents);
+    }
+
+    bool isAscii() const {
+        for (char c : contents) {
+            if (static_cast<unsigned char>(c) >= 0x80) return false;
+        }
+        return true;
+    }
+
+    // ICCCM asks owners for a real timestamp rather than CurrentTime; a
+    // zero-length property append on our own window yields one
+    Time serverTime() {
+        unsigned char none = 0;
+        XChangeProperty(display, window, timestampAtom, XA_STRING, 8, PropModeAppend, &none, 0);
+        XEvent event;
+        do {
+            XWindowEvent(display, window, PropertyChangeMask, &event);
+        } while (event.xproperty.atom != timestampAtom);
+        return event.xproperty.time;
+    }
+
+    void answer(const XSelectionRequestEvent& request) {
+        XSelectionEvent reply;
+        reply.type = SelectionNotify;
+        reply.display = request.display;
+        reply.requestor = request.requestor;
+        reply.selection = request.selection;
+        reply.target = request.target;
+        reply.time = request.time;
+        // Obsolete clients leave the property unset and expect the target
+        reply.property = request.property != None ? request.property : request.target;
+
+        bool inTime = request.time == CurrentTime || request.time >= ownedSince;
+        if (!owned || request.selection != clipboardAtom || !inTime) {
+            reply.property = None;
+        } else if (request.target == targetsAtom) {
+            Atom targets[] = { targetsAtom, utf8Atom, mimeAtom, textAtom, XA_STRING };
+            int count = sizeof(targets) / sizeof(targets[0]) - (isAscii() ? 0 : 1);
+            XChangeProperty(display, request.requestor, reply.property, XA_ATOM, 32, PropModeReplace,
+                            reinterpret_cast<unsigned char*>(targets), count);
+        } else if (request.target == utf8Atom || request.target == mimeAtom ||
+                   request.target == textAtom || (request.target == XA_STRING && isAscii())) {
+            // The UTF-8 bytes go out unchanged; ASCII is valid Latin-1 too.
+            // They are far below the request size limit, so no INCR.
+            Atom type = request.target == textAtom ? utf8Atom : request.target;
+            XChangeProperty(display, request.requestor, reply.property, type, 8, PropModeReplace,
+                            reinterpret_cast<const unsigned char*>(contents.data()),
+                            static_cast<int>(contents.size()));
+        } else {
+            reply.property = None;
+        }
+
+        XSendEvent(display, request.requestor, False, NoEventMask, reinterpret_cast<XEvent*>(&reply));
+        XFlush(display);
+    }
+};
+
+#endif // PWGEN_X11_CLIPBOARD_H
@@ -0,0 +1,214 @@
+#ifndef PWGEN_BREACH_H
+#define PWGEN_BREACH_H
+
+// Memory-mapped corpus of breached passwords, for offline screening.
+//
+// The Have I Been Pwned "Pwned Passwords" list (SHA-1 hashes, about 900M of
+// them) is converted once by dict/pwbreachc.cpp into a sorted table of
+// truncated hashes with a prefix index. The first 24 bits of a hash pick a
+// bucket in the index, and the next suffixBytes bytes (5 by default, 64 bits
+// in all) are stored sorted within it, so about 40 GB of text shrinks to
+// about 4.6 GB.
+//
+// A lookup reads two index entries and binary-searches a bucket of about 50
+// entries: a couple of page touches, no parsing and no network. The mapping
+// is advised MADV_RANDOM so the kernel doesn't read ahead around them.
+//
+// Truncation admits false positives, about count / 2^64 per lookup at the
+// default width (1 in 20 billion for the full list): a generated password is
+// then regenerated needlessly, which costs nothing.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "dictionary.h"
+#include "sha1.h"
+
+namespace pwgen {
+
+const char BREACH_MAGIC[8] = { 'P', 'W', 'B', 'R', 'E', 'A', 'C', 'H' };
+const uint32_t BREACH_VERSION = 1;
+const uint32_t BREACH_BYTE_ORDER = 0x01020304;
+const uint32_t BREACH_PREFIX_BITS = 24;
+const uint32_t BREACH_BUCKETS = 1u << BREACH_PREFIX_BITS;
+const uint32_t BREACH_MAX_SUFFIX = SHA1_DIGEST_SIZE - BREACH_PREFIX_BITS / 8;
+
+// Generation gives up after this many breached candidates in a row; only a
+// tiny keyspace (e.g. short digit-only PINs) gets anywhere near it
+const int BREACH_MAX_RETRIES = 1000;
+
+// File layout: BreachHeader, uint32_t index[BREACH_BUCKETS + 1] (entries
+// before each bucket), then `count` entries of suffixBytes bytes: hash bytes
+// 3 .. 3 + suffixBytes, sorted.
+struct BreachHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;    // BREACH_BYTE_ORDER as written by the compiler
+    uint32_t prefixBits;   // BREACH_PREFIX_BITS
+    uint32_t suffixBytes;
+    uint64_t count;        // hashes, at most UINT32_MAX
+    uint64_t totalSize;    // whole file
+};
+
+class BreachCorpus {
+public:
+    BreachCorpus() {}
+
+    ~BreachCorpus() { close(); }
+
+    // Map a compiled corpus; false (and an empty corpus) if the file is
+    // missing or malformed. Checks only the header and the index's last
+    // entry, so opening a multi-gigabyte corpus touches two pages.
+    bool open(const std::string& path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BreachHeader))) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        madvise(mapped, static_cast<size_t>(st.st_size), MADV_RANDOM);
+        base = static_cast<const unsigned char*>(mapped);
+        size = static_cast<size_t>(st.st_size);
+        isMapped = true;
+#else
+        // No mmap(): read the blob into one buffer, still without parsing it
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        unsigned char chunk[65536];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            copy.insert(copy.end(), chunk, chunk + got);
+        }
+        fclose(file);
+        base = copy.data();
+        size = copy.size();
+#endif
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (isMapped) munmap(const_cast<unsigned char*>(base), size);
+#endif
+        isMapped = false;
+        copy.clear();
+        base = nullptr;
+        size = 0;
+        header = nullptr;
+        index = nullptr;
+        entries = nullptr;
+    }
+
+    bool empty() const { return header == nullptr; }
+
+    size_t count() const { return header ? static_cast<size_t>(header->count) : 0; }
+
+    // Is this SHA-1 digest in the corpus? Safe from any number of threads.
+    bool containsDigest(const unsigned char digest[SHA1_DIGEST_SIZE]) const {
+        if (!header) return false;
+        uint32_t bucket = uint32_t(digest[0]) << 16 | uint32_t(digest[1]) << 8 | digest[2];
+        uint32_t lo = index[bucket];
+        uint32_t hi = index[bucket + 1];
+        if (lo > hi || hi > header->count) return false;   // corrupt index
+
+        const unsigned char* key = digest + BREACH_PREFIX_BITS / 8;
+        const size_t width = header->suffixBytes;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            int order = memcmp(entries + size_t(mid) * width, key, width);
+            if (order == 0) return true;
+            if (order < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return false;
+    }
+
+    // Is this password (hashed as given, like the HIBP list) in the corpus?
+    bool contains(const char* password, size_t length) const {
+        if (!header) return false;
+        unsigned char digest[SHA1_DIGEST_SIZE];
+        sha1(password, length, digest);
+        bool found = containsDigest(digest);
+        secureZero(digest, sizeof(digest));
+        return found;
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    bool isMapped = false;
+    std::vector<unsigned char> copy;
+
+    const BreachHeader* header = nullptr;
+    const uint32_t* index = nullptr;
+    const unsigned char* entries = nullptr;
+
+    BreachCorpus(const BreachCorpus&);
+    BreachCorpus& operator=(const BreachCorpus&);
+
+    bool validate() {
+        const BreachHeader* h = reinterpret_cast<const BreachHeader*>(base);
+        if (memcmp(h->magic, BREACH_MAGIC, sizeof(BREACH_MAGIC)) != 0) return false;
+        if (h->version != BREACH_VERSION || h->byteOrder != BREACH_BYTE_ORDER) return false;
+        if (h->prefixBits != BREACH_PREFIX_BITS) return false;
+        if (h->suffixBytes == 0 || h->suffixBytes > BREACH_MAX_SUFFIX) return false;
+        if (h->totalSize != size || h->count > UINT32_MAX) return false;
+
+        uint64_t needed = sizeof(BreachHeader) + (uint64_t(BREACH_BUCKETS) + 1) * sizeof(uint32_t) +
+                          h->count * h->suffixBytes;
+        if (needed > size) return false;
+
+        // Buckets are bounds-checked per lookup instead of all up front
+        const uint32_t* i = reinterpret_cast<const uint32_t*>(base + sizeof(BreachHeader));
+        if (i[BREACH_BUCKETS] != h->count) return false;
+
+        header = h;
+        index = i;
+        entries = reinterpret_cast<const unsigned char*>(i + BREACH_BUCKETS + 1);
+        return true;
+    }
+};
+
+// Process-wide corpus, mapped on first use from $PWGEN_BREACH, then
+// pwgen.breach beside the executable, then PWGEN_DICT_DIR. Stays empty if
+// none of them exists, and screening is then skipped.
+inline const BreachCorpus& defaultBreachCorpus() {
+    struct Loader {
+        BreachCorpus corpus;
+        Loader() {
+            const char* env = getenv("PWGEN_BREACH");
+            if (env && *env && corpus.open(env)) return;
+            std::string beside = executableSiblingPath("pwgen.breach");
+            if (!beside.empty() && corpus.open(beside)) return;
+            corpus.open(PWGEN_DICT_DIR "/pwgen.breach");
+        }
+    };
+    static const Loader loader;
+    return loader.corpus;
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_BREACH_H
@@ -0,0 +1,276 @@
+#ifndef PWGEN_CHARSET_KERNEL_H
+#define PWGEN_CHARSET_KERNEL_H
+
+// Fused rejection test + alphabet lookup: random bytes in, password characters out.
+//
+// Same arithmetic as IndexSampler::map (Lemire multiply-shift on one byte),
+// so every path produces bit-identical output for a given random stream.
+// On x86 the SSE4.1 and AVX2 variants handle 16/32 bytes per step: the
+// rejection test runs on 16-bit products, the lookup is a pshufb per 16-entry
+// slice of the alphabet, and accepted characters are left-packed through an
+// 8-lane shuffle table. The widest supported variant is picked at runtime.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "index_sampler.h"
+#include "secure_random.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define PWGEN_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define PWGEN_HAVE_X86_SIMD 0
+#endif
+
+namespace pwgen {
+
+enum class SimdLevel {
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::SSE41: return "sse4.1";
+        case SimdLevel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+// Widest kernel this CPU can run, detected once
+inline SimdLevel detectSimdLevel() {
+#if PWGEN_HAVE_X86_SIMD
+    static const SimdLevel level = []() -> SimdLevel {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE41;
+        return SimdLevel::Scalar;
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+namespace detail {
+
+// Reference kernel; the SIMD variants finish their tails with it
+inline size_t mapCharsScalar(const uint8_t* bytes, size_t count, const char* alphabet,
+                             unsigned int n, uint8_t t, char* out, size_t capacity,
+                             size_t& consumed) {
+    size_t written = 0;
+    size_t i = 0;
+    for (; i < count && written < capacity; i++) {
+        unsigned int m = bytes[i] * n;
+        if ((m & 0xFF) >= t) {
+            out[written++] = alphabet[m >> 8];
+        }
+    }
+    consumed = i;
+    return written;
+}
+
+#if PWGEN_HAVE_X86_SIMD
+
+// For each 8-bit accept mask, the byte shuffle that left-packs the kept lanes
+struct PackTable {
+    alignas(16) uint8_t lanes[256][8];
+    uint8_t counts[256];
+
+    PackTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int k = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                if (mask & (1 << bit)) lanes[mask][k++] = static_cast<uint8_t>(bit);
+            }
+            counts[mask] = static_cast<uint8_t>(k);
+            for (; k < 8; k++) lanes[mask][k] = 0x80;
+        }
+    }
+};
+
+inline const PackTable& packTable() {
+    static const PackTable table;
+    return table;
+}
+
+// Store the accepted lanes of an 8-byte group at `out`; returns how many.
+// Always writes 8 bytes, so the caller keeps 8 bytes of slack.
+__attribute__((target("sse4.1")))
+inline size_t packGroup(__m128i chars, unsigned int mask, const PackTable& table, char* out) {
+    __m128i shuffle = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(table.lanes[mask]));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(chars, shuffle));
+    return table.counts[mask];
+}
+
+__attribute__((target("sse4.1")))
+inline size_t mapCharsSse41(const uint8_t* bytes, size_t count, const char* alphabet,
+                            unsigned int n, uint8_t t, char* out, size_t capacity,
+                            size_t& consumed) {
+    const PackTable& table = packTable();
+    const unsigned int slices = (n + 15) / 16;
+    __m128i lut[16];
+    for (unsigned int s = 0; s < slices; s++) {
+        lut[s] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(alphabet + 16 * s));
+    }
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mul = _mm_set1_epi16(static_cast<short>(n));
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i thresh = _mm_set1_epi8(static_cast<char>(t));
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= count && written + 16 <= capacity; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        __m128i mlo = _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), mul);
+        __m128i mhi = _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), mul);
+        __m128i idx = _mm_packus_epi16(_mm_srli_epi16(mlo, 8), _mm_srli_epi16(mhi, 8));
+        __m128i low = _mm_packus_epi16(_mm_and_si128(mlo, lowMask), _mm_and_si128(mhi, lowMask));
+        __m128i accept = _mm_cmpeq_epi8(_mm_max_epu8(low, thresh), low);
+
+        __m128i lo4 = _mm_and_si128(idx, nibble);
+        __m128i hi4 = _mm_and_si128(_mm_srli_epi16(idx, 4), nibble);
+        __m128i chars = _mm_shuffle_epi8(lut[0], lo4);
+        for (unsigned int s = 1; s < slices; s++) {
+            __m128i hit = _mm_cmpeq_epi8(hi4, _mm_set1_epi8(static_cast<char>(s)));
+            chars = _mm_blendv_epi8(chars, _mm_shuffle_epi8(lut[s], lo4), hit);
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(accept));
+        written += packGroup(chars, mask & 0xFF, table, out + written);
+        written += packGroup(_mm_srli_si128(chars, 8), mask >> 8, table, out + written);
+    }
+
+    size_t tail = 0;
+    written += mapCharsScalar(bytes + i, count - i, alphabet, n, t,
+                              out + written, capacity - written, tail);
+    consumed = i + tail;
+    return written;
+}
+
+__attribute__((target("avx2")))
+inline size_t mapCharsAvx2(const uint8_t* bytes, size_t count, const char* alphabet,
+                           unsigned int n, uint8_t t, char* out, size_t capacity,
+                           size_t& consumed) {
+    const PackTable& table = packTable();
+    const unsigned int slices = (n + 15) / 16;
+    __m256i lut[16];
+    for (unsigned int s = 0; s < slices; s++) {
+        // vpshufb looks up within each 128-bit lane, so both lanes get the slice
+        lut[s] = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(alphabet + 16 * s)));
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mul = _mm256_set1_epi16(static_cast<short>(n));
+    const __m256i lowMask = _mm256_set1_epi16(0x00FF);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i thresh = _mm256_set1_epi8(static_cast<char>(t));
+
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 32 <= count && written + 32 <= capacity; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+        // unpack/pack work per lane, so the byte order is preserved end to end
+        __m256i mlo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), mul);
+        __m256i mhi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), mul);
+        __m256i idx = _mm256_packus_epi16(_mm256_srli_epi16(mlo, 8), _mm256_srli_epi16(mhi, 8));
+        __m256i low = _mm256_packus_epi16(_mm256_and_si256(mlo, lowMask), _mm256_and_si256(mhi, lowMask));
+        __m256i accept = _mm256_cmpeq_epi8(_mm256_max_epu8(low, thresh), low);
+
+        __m256i lo4 = _mm256_and_si256(idx, nibble);
+        __m256i hi4 = _mm256_and_si256(_mm256_srli_epi16(idx, 4), nibble);
+        __m256i chars = _mm256_shuffle_epi8(lut[0], lo4);
+        for (unsigned int s = 1; s < slices; s++) {
+            __m256i hit = _mm256_cmpeq_epi8(hi4, _mm256_set1_epi8(static_cast<char>(s)));
+            chars = _mm256_blendv_epi8(chars, _mm256_shuffle_epi8(lut[s], lo4), hit);
+        }
+
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(accept));
+        __m128i first = _mm256_castsi256_si128(chars);
+        __m128i second = _mm256_extracti128_si256(chars, 1);
+        written += packGroup(first, mask & 0xFF, table, out + written);
+        written += packGroup(_mm_srli_si128(first, 8), (mask >> 8) & 0xFF, table, out + written);
+        written += packGroup(second, (mask >> 16) & 0xFF, table, out + written);
+        written += packGroup(_mm_srli_si128(second, 8), mask >> 24, table, out + written);
+    }
+
+    size_t tail = 0;
+    written += mapCharsScalar(bytes + i, count - i, alphabet, n, t,
+                              out + written, capacity - written, tail);
+    consumed = i + tail;
+    return written;
+}
+
+#endif // PWGEN_HAVE_X86_SIMD
+
+} // namespace detail
+
+// Turns random bytes into characters of one alphabet (1..256 symbols)
+class CharsetKernel {
+public:
+    explicit CharsetKernel(const std::string& alphabet, SimdLevel level = detectSimdLevel())
+        : sampler(static_cast<unsigned int>(alphabet.size())), simd(level) {
+        if (alphabet.size() > sizeof(table)) {
+            throw std::invalid_argument("alphabet larger than 256 characters");
+        }
+        // Zero padding keeps the 16-byte slice loads inside the table
+        memset(table, 0, sizeof(table));
+        memcpy(table, alphabet.data(), alphabet.size());
+    }
+
+    unsigned int size() const { return sampler.size(); }
+
+    SimdLevel level() const { return simd; }
+
+    // Map `count` random bytes into at most `capacity` characters.
+    // Returns characters written; `consumed` receives bytes examined.
+    size_t map(const uint8_t* bytes, size_t count, char* out, size_t capacity, size_t& consumed) const {
+        switch (simd) {
+#if PWGEN_HAVE_X86_SIMD
+            case SimdLevel::AVX2:
+                return detail::mapCharsAvx2(bytes, count, table, sampler.size(), sampler.threshold(),
+                                            out, capacity, consumed);
+            case SimdLevel::SSE41:
+                return detail::mapCharsSse41(bytes, count, table, sampler.size(), sampler.threshold(),
+                                             out, capacity, consumed);
+#endif
+            default:
+                return detail::mapCharsScalar(bytes, count, table, sampler.size(), sampler.threshold(),
+                                              out, capacity, consumed);
+        }
+    }
+
+    // Fill `count` characters, drawing random bytes from `source` in blocks
+    void sample(RandomSource& source, char* out, size_t count) const {
+        const uint8_t t = sampler.threshold();
+        uint8_t block[1024];
+        size_t touched = 0;
+        while (count > 0) {
+            size_t want = count + (count * t) / (256 - t) + 8;
+            want = std::min(want, sizeof(block));
+            source.fill(block, want);
+            touched = std::max(touched, want);
+            size_t consumed;
+            size_t got = map(block, want, out, count, consumed);
+            out += got;
+            count -= got;
+        }
+        secureZero(block, touched);
+    }
+
+private:
+    IndexSampler sampler;
+    SimdLevel simd;
+    char table[256];
+};
+
+} // namespace pwgen
+
+#endif // PWGEN_CHARSET_KERNEL_H
@@ -0,0 +1,239 @@
+#ifndef PWGEN_CHARSET_POLICY_H
+#define PWGEN_CHARSET_POLICY_H
+
+// Character-set policy compiled once from the option flags.
+//
+// Holds the flattened alphabet, the sub-range of each enabled class and a
+// ready CharsetKernel (with its rejection threshold) for the alphabet and
+// for every class, so generating a password does no string building.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "charset_kernel.h"
+#include "index_sampler.h"
+#include "secure_random.h"
+#include "strength.h"
+
+namespace pwgen {
+
+const char* const UPPERCASE = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const char* const LOWERCASE = "abcdefghijklmnopqrstuvwxyz";
+const char* const DIGITS = "0123456789";
+const char* const SPECIAL = "!@#$%^&*()-_=+[]{};:,.<>?/";
+const char* const SIMILAR = "Il1O0";
+
+enum class CharClass {
+    Upper,
+    Lower,
+    Digit,
+    Special
+};
+
+struct CharsetOptions {
+    bool useUpper = true;
+    bool useLower = true;
+    bool useDigits = true;
+    bool useSpecial = true;
+    bool enforceMinimum = true;
+    bool avoidSimilar = false;
+
+    bool operator==(const CharsetOptions& other) const {
+        return useUpper == other.useUpper && useLower == other.useLower &&
+               useDigits == other.useDigits && useSpecial == other.useSpecial &&
+               enforceMinimum == other.enforceMinimum && avoidSimilar == other.avoidSimilar;
+    }
+
+    bool operator!=(const CharsetOptions& other) const {
+        return !(*this == other);
+    }
+};
+
+class CharsetPolicy {
+public:
+    // One enabled class: its slice of the flattened alphabet and its own kernel
+    struct ClassRange {
+        CharClass charClass;
+        size_t offset;
+        size_t size;
+        CharsetKernel kernel;
+    };
+
+    explicit CharsetPolicy(const CharsetOptions& requested) : opts(requested) {
+        // At least one class must be enabled; fall back to lowercase
+        if (!opts.useUpper && !opts.useLower && !opts.useDigits && !opts.useSpecial) {
+            opts.useLower = true;
+        }
+
+        if (opts.useUpper) addClass(CharClass::Upper, UPPERCASE, CLASS_UPPER);
+        if (opts.useLower) addClass(CharClass::Lower, LOWERCASE, CLASS_LOWER);
+        if (opts.useDigits) addClass(CharClass::Digit, DIGITS, CLASS_DIGIT);
+        if (opts.useSpecial) addClass(CharClass::Special, SPECIAL, CLASS_SPECIAL);
+
+        full.reset(new CharsetKernel(chars));
+    }
+
+    CharsetPolicy(const CharsetPolicy&) = delete;
+    CharsetPolicy& operator=(const CharsetPolicy&) = delete;
+
+    // Options after normalization (e.g. lowercase forced on if nothing was)
+    const CharsetOptions& options() const { return opts; }
+
+    const std::string& alphabet() const { return chars; }
+
+    const CharsetKernel& kernel() const { return *full; }
+
+    const std::vector<ClassRange>& classes() const { return ranges; }
+
+    // Shortest length that can hold one character of each required class
+    size_t minimumLength() const {
+        return opts.enforceMinimum ? ranges.size() : 1;
+    }
+
+    // CLASS_* bits of every enabled class
+    uint8_t coverage() const { return classBits; }
+
+    // Shannon entropy, in bits, of a `length`-character password from this
+    // policy. Without enforceMinimum every password is a uniform draw, so
+    // that is length * log2(alphabet). With it, generateInto() writes one
+    // character of each of the k required classes over k random positions of
+    // a uniform string, which favours passwords with many of a class. A
+    // password with c_i characters of class i has probability
+    //   prod(c_i) * (L-k)! / L! / prod(size_i) / N^(L-k)
+    // and each c_i is 1 + Binomial(L-k, size_i / N), so the entropy is exact
+    // and somewhat below log2 of the number of valid passwords.
+    double entropyBits(size_t length) const {
+        if (length < minimumLength() || chars.empty()) return 0;
+
+        double alphabet = static_cast<double>(chars.size());
+        if (!opts.enforceMinimum) return length * log2(alphabet);
+
+        size_t k = ranges.size();
+        double rest = static_cast<double>(length - k);
+        double bits = rest * log2(alphabet);
+        for (size_t i = 0; i < k; i++) {
+            bits += log2(static_cast<double>(length - i)) + log2(static_cast<double>(ranges[i].size));
+            bits -= expectedLog2Count(rest, ranges[i].size / alphabet);
+        }
+        return bits;
+    }
+
+    // Score every password of `length` gets, known before generating, or -1 if
+    // it depends on the draw (enforceMinimum off and more than one class).
+    int expectedStrength(size_t length) const {
+        if (opts.enforceMinimum || ranges.size() == 1) {
+            return scoreFromCoverage(classBits, length);
+        }
+        return -1;
+    }
+
+    // Write one password of `length` characters (at least minimumLength())
+    // to `out`. No allocation; `out` is not NUL-terminated. Its strength is
+    // a property of the policy (entropyBits(), expectedStrength()), so
+    // nothing is scored per password.
+    void generateInto(RandomSource& source, char* out, size_t length) const {
+        // Sample every position from the full alphabet in one block of random bytes
+        full->sample(source, out, length);
+        placeRequired(source, out, length);
+    }
+
+    // Write `count` passwords into `arena`, one every `stride` bytes (stride >=
+    // length; stride == length packs them back to back). Bytes between the end
+    // of one password and the next slot are left untouched, so callers can
+    // pre-fill delimiters. Characters are sampled in large kernel passes.
+    void generateBatch(RandomSource& source, char* arena, size_t count, size_t length, size_t stride) const {
+        if (count == 0 || length == 0) return;
+        if (stride < length) stride = length;
+
+        if (stride == length) {
+            full->sample(source, arena, count * length);
+        } else {
+            // Sample through a scratch block and scatter into the slots
+            char scratch[4096];
+            size_t slot = 0, offset = 0;
+            size_t remaining = count * length;
+            while (remaining > 0) {
+                size_t n = std::min(remaining, sizeof(scratch));
+                full->sample(source, scratch, n);
+                for (size_t done = 0; done < n;) {
+                    size_t take = std::min(n - done, length - offset);
+                    memcpy(arena + slot * stride + offset, scratch + done, take);
+                    done += take;
+                    offset += take;
+                    if (offset == length) {
+                        offset = 0;
+                        slot++;
+                    }
+                }
+                remaining -= n;
+            }
+            secureZero(scratch, sizeof(scratch));
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            placeRequired(source, arena + i * stride, length);
+        }
+    }
+
+    // Convenience wrapper over generateInto()
+    std::string generate(RandomSource& source, size_t length) const {
+        std::string password(length, '\0');
+        generateInto(source, &password[0], length);
+        return password;
+    }
+
+private:
+    CharsetOptions opts;
+    std::string chars;
+    std::vector<ClassRange> ranges;
+    std::unique_ptr<CharsetKernel> full;
+    uint8_t classBits = 0;
+
+    // E[log2(1 + X)] for X ~ Binomial(n, p): the expected log2 of how many
+    // characters of a required class a password has, given the one placed
+    static double expectedLog2Count(double n, double p) {
+        if (p >= 1) return log2(n + 1);
+        double sum = 0;
+        double logFactorial = lgamma(n + 1);
+        for (double j = 0; j <= n; j++) {
+            double logPmf = logFactorial - lgamma(j + 1) - lgamma(n - j + 1) +
+                            j * log(p) + (n - j) * log1p(-p);
+            sum += exp(logPmf) * log2(j + 1);
+        }
+        return sum;
+    }
+
+    // Place one of each required class at distinct random positions. This is
+    // distributed exactly like prepending them and shuffling the password.
+    void placeRequired(RandomSource& source, char* out, size_t length) const {
+        if (!opts.enforceMinimum) return;
+
+        size_t positions[4];
+        choosePositions(source, length, ranges.size(), positions);
+        for (size_t i = 0; i < ranges.size(); i++) {
+            ranges[i].kernel.sample(source, out + positions[i], 1);
+        }
+    }
+
+    void addClass(CharClass charClass, const char* set, uint8_t bit) {
+        std::string filtered;
+        for (const char* c = set; *c; c++) {
+            if (!opts.avoidSimilar || !strchr(SIMILAR, *c)) {
+                filtered += *c;
+            }
+        }
+        ClassRange range = { charClass, chars.size(), filtered.size(), CharsetKernel(filtered) };
+        ranges.push_back(range);
+        chars += filtered;
+        classBits |= bit;
+    }
+};
+
+} // namespace pwgen
+
+#endif // PWGEN_CHARSET_POLICY_H
@@ -0,0 +1,218 @@
+// pwbreachc - compile a breached-password list into the prefix-indexed corpus
+// that breach screening memory-maps (see ../breach.h for the format).
+//
+// Usage: pwbreachc [-b bytes] [-c min-count] -o pwgen.breach pwned-passwords-sha1.txt
+//        pwbreachc [-b bytes] -o pwgen.breach --plain passwords.txt
+//
+// The HIBP download ("HASH:COUNT" lines, ordered by hash, as fetched by the
+// PwnedPasswordsDownloader) is streamed in one pass with constant memory, so
+// the full list converts without loading it. -c drops hashes seen fewer than
+// min-count times to shrink the corpus. -b sets the stored bytes per hash
+// after the 3-byte prefix (default 5: 64 bits, 1 to 17).
+//
+// --plain reads one plaintext password per line instead, hashes and sorts
+// them in memory; meant for local lists of modest size.
+//
+// Build: g++ -O2 -std=c++11 -o pwbreachc libpwgen/dict/pwbreachc.cpp
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../breach.h"
+
+namespace {
+
+typedef std::array<unsigned char, pwgen::SHA1_DIGEST_SIZE> Digest;
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool parseHash(const std::string& line, Digest& digest) {
+    if (line.size() < 2 * digest.size()) return false;
+    for (size_t i = 0; i < digest.size(); i++) {
+        int hi = hexValue(line[2 * i]);
+        int lo = hexValue(line[2 * i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        digest[i] = static_cast<unsigned char>(hi << 4 | lo);
+    }
+    return line.size() == 2 * digest.size() || line[2 * digest.size()] == ':' ||
+           line[2 * digest.size()] == '\r';
+}
+
+// Writes entries as they arrive (in hash order), then goes back for the
+// header and index once every bucket's size is known
+class CorpusWriter {
+public:
+    explicit CorpusWriter(uint32_t suffix) : suffixBytes(suffix), counts(pwgen::BREACH_BUCKETS + 1, 0) {}
+
+    ~CorpusWriter() {
+        if (file) fclose(file);
+    }
+
+    bool open(const std::string& path) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        // Placeholders, rewritten by finish()
+        pwgen::BreachHeader header;
+        memset(&header, 0, sizeof(header));
+        return fwrite(&header, sizeof(header), 1, file) == 1 &&
+               fwrite(counts.data(), sizeof(uint32_t), counts.size(), file) == counts.size();
+    }
+
+    // false if `digest` breaks the order; repeats are skipped
+    bool add(const Digest& digest) {
+        const size_t keyBytes = pwgen::BREACH_PREFIX_BITS / 8 + suffixBytes;
+        if (written > 0) {
+            int order = memcmp(digest.data(), previous.data(), keyBytes);
+            if (order < 0) return false;
+            if (order == 0) return true;   // equal once truncated
+        }
+        previous = digest;
+        uint32_t bucket = uint32_t(digest[0]) << 16 | uint32_t(digest[1]) << 8 | digest[2];
+        counts[bucket + 1]++;
+        written++;
+        failed |= fwrite(digest.data() + pwgen::BREACH_PREFIX_BITS / 8, 1, suffixBytes, file) != suffixBytes;
+        return true;
+    }
+
+    bool finish() {
+        if (written > UINT32_MAX) return false;
+        for (size_t i = 1; i < counts.size(); i++) {
+            counts[i] += counts[i - 1];
+        }
+        pwgen::BreachHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, pwgen::BREACH_MAGIC, sizeof(header.magic));
+        header.version = pwgen::BREACH_VERSION;
+        header.byteOrder = pwgen::BREACH_BYTE_ORDER;
+        header.prefixBits = pwgen::BREACH_PREFIX_BITS;
+        header.suffixBytes = suffixBytes;
+        header.count = written;
+        header.totalSize = sizeof(header) + uint64_t(counts.size()) * sizeof(uint32_t) +
+                           uint64_t(written) * suffixBytes;
+
+        rewind(file);
+        bool ok = !failed && fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(counts.data(), sizeof(uint32_t), counts.size(), file) == counts.size();
+        ok = fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    uint64_t count() const { return written; }
+
+private:
+    const uint32_t suffixBytes;
+    std::vector<uint32_t> counts;   // entries per bucket, shifted by one
+    FILE* file = nullptr;
+    Digest previous;
+    uint64_t written = 0;
+    bool failed = false;
+};
+
+void usage() {
+    std::cerr << "Usage: pwbreachc [-b bytes] [-c min-count] -o OUTPUT pwned-passwords-sha1.txt" << std::endl
+              << "       pwbreachc [-b bytes] -o OUTPUT --plain passwords.txt" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::string input;
+    bool plain = false;
+    long minCount = 0;
+    long suffix = 5;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "-b" && i + 1 < argc) {
+            suffix = strtol(argv[++i], nullptr, 10);
+        } else if (arg == "-c" && i + 1 < argc) {
+            minCount = strtol(argv[++i], nullptr, 10);
+        } else if (arg == "--plain") {
+            plain = true;
+        } else if (input.empty() && arg[0] != '-') {
+            input = arg;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (output.empty() || input.empty()) {
+        usage();
+        return 1;
+    }
+    if (suffix < 1 || suffix > static_cast<long>(pwgen::BREACH_MAX_SUFFIX)) {
+        std::cerr << "Error: -b must be between 1 and " << pwgen::BREACH_MAX_SUFFIX << "." << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(input);
+    if (!in) {
+        std::cerr << "Error: cannot read " << input << std::endl;
+        return 1;
+    }
+    CorpusWriter writer(static_cast<uint32_t>(suffix));
+    if (!writer.open(output)) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return 1;
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    if (plain) {
+        std::vector<Digest> digests;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+            if (line.empty()) continue;
+            Digest digest;
+            pwgen::sha1(line.data(), line.size(), digest.data());
+            digests.push_back(digest);
+        }
+        std::sort(digests.begin(), digests.end());
+        for (const Digest& digest : digests) {
+            writer.add(digest);
+        }
+    } else {
+        Digest digest;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (line.empty()) continue;
+            if (!parseHash(line, digest)) {
+                std::cerr << "Error: " << input << ":" << lineNumber << ": expected HASH:COUNT" << std::endl;
+                return 1;
+            }
+            if (minCount > 1) {
+                size_t colon = line.find(':');
+                long seen = colon == std::string::npos ? 1 : strtol(line.c_str() + colon + 1, nullptr, 10);
+                if (seen < minCount) continue;
+            }
+            if (!writer.add(digest)) {
+                std::cerr << "Error: " << input << ":" << lineNumber
+                          << ": not ordered by hash (use the ordered download, or sort it)" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (!writer.finish()) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return 1;
+    }
+    std::cout << output << ": " << writer.count() << " hashes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,238 @@
+// pwdictc - compile ranked wordlists into the dictionary blob the strength
+// estimator memory-maps (see ../dictionary.h for the format).
+//
+// Usage: pwdictc -o pwgen.dict name=wordlist.txt [name=wordlist.txt ...]
+//
+// Each wordlist has one word per line, most common first; anything after the
+// first whitespace on a line (e.g. a frequency count) is ignored. Words are
+// folded to ASCII lowercase. A word in several lists keeps its best rank.
+//
+// Build: g++ -O2 -std=c++11 -o pwdictc libpwgen/dict/pwdictc.cpp
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../dictionary.h"
+
+namespace {
+
+const size_t MIN_WORD = 3;
+
+struct TrieNode {
+    std::map<unsigned char, uint32_t> children;
+    uint32_t fail = 0;
+    uint32_t output = 0;
+    uint32_t rank = 0;
+    uint8_t list = 0;
+    uint8_t depth = 0;
+};
+
+class TrieBuilder {
+public:
+    TrieBuilder() : nodes(1) {}
+
+    // Returns true if the word is new to the automaton
+    bool add(const std::string& word, uint32_t rank, uint8_t list) {
+        uint32_t state = 0;
+        for (unsigned char c : word) {
+            auto it = nodes[state].children.find(c);
+            if (it == nodes[state].children.end()) {
+                uint32_t next = static_cast<uint32_t>(nodes.size());
+                nodes[state].children[c] = next;
+                nodes.push_back(TrieNode());
+                nodes[next].depth = static_cast<uint8_t>(nodes[state].depth + 1);
+                state = next;
+            } else {
+                state = it->second;
+            }
+        }
+        TrieNode& node = nodes[state];
+        bool added = node.rank == 0;
+        if (added || rank < node.rank) {
+            node.rank = rank;
+            node.list = list;
+        }
+        return added;
+    }
+
+    // Renumber nodes breadth-first, then fill in failure and output links
+    void link() {
+        std::vector<uint32_t> order;
+        std::vector<uint32_t> renumber(nodes.size());
+        std::deque<uint32_t> queue(1, 0);
+        while (!queue.empty()) {
+            uint32_t state = queue.front();
+            queue.pop_front();
+            renumber[state] = static_cast<uint32_t>(order.size());
+            order.push_back(state);
+            for (const auto& edge : nodes[state].children) {
+                queue.push_back(edge.second);
+            }
+        }
+
+        std::vector<TrieNode> sorted(nodes.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            sorted[i] = nodes[order[i]];
+            for (auto& edge : sorted[i].children) {
+                edge.second = renumber[edge.second];
+            }
+        }
+        nodes.swap(sorted);
+
+        // Breadth-first order means every fail target is already linked
+        for (uint32_t state = 0; state < nodes.size(); state++) {
+            for (const auto& edge : nodes[state].children) {
+                uint32_t target = edge.second;
+                uint32_t fail = 0;
+                if (state != 0) {
+                    uint32_t probe = nodes[state].fail;
+                    for (;;) {
+                        auto it = nodes[probe].children.find(edge.first);
+                        if (it != nodes[probe].children.end()) {
+                            fail = it->second;
+                            break;
+                        }
+                        if (probe == 0) break;
+                        probe = nodes[probe].fail;
+                    }
+                }
+                nodes[target].fail = fail;
+                nodes[target].output = nodes[fail].rank ? fail : nodes[fail].output;
+            }
+        }
+    }
+
+    bool write(const std::string& path, const std::vector<std::string>& lists, uint32_t words) const {
+        std::string names;
+        for (const std::string& name : lists) {
+            names += name;
+            names += '\0';
+        }
+
+        uint32_t edgeCount = 0;
+        std::vector<pwgen::DictNode> flat(nodes.size());
+        std::vector<uint32_t> targets;
+        std::vector<uint8_t> labels;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            pwgen::DictNode& out = flat[i];
+            memset(&out, 0, sizeof(out));
+            out.firstEdge = edgeCount;
+            out.edgeCount = static_cast<uint16_t>(nodes[i].children.size());
+            out.fail = nodes[i].fail;
+            out.output = nodes[i].output;
+            out.rank = nodes[i].rank;
+            out.list = nodes[i].list;
+            out.depth = nodes[i].depth;
+            for (const auto& edge : nodes[i].children) {
+                labels.push_back(edge.first);
+                targets.push_back(edge.second);
+                edgeCount++;
+            }
+        }
+
+        pwgen::DictHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, pwgen::DICT_MAGIC, sizeof(header.magic));
+        header.version = pwgen::DICT_VERSION;
+        header.byteOrder = pwgen::DICT_BYTE_ORDER;
+        header.nodeCount = static_cast<uint32_t>(flat.size());
+        header.edgeCount = edgeCount;
+        header.listCount = static_cast<uint32_t>(lists.size());
+        header.namesSize = static_cast<uint32_t>(names.size());
+        header.wordCount = words;
+
+        size_t total = sizeof(header) + flat.size() * sizeof(pwgen::DictNode) +
+                       targets.size() * sizeof(uint32_t) + labels.size() + names.size();
+        size_t padding = (4 - total % 4) % 4;
+        header.totalSize = static_cast<uint32_t>(total + padding);
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file) return false;
+        const char zeros[4] = { 0, 0, 0, 0 };
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(flat.data(), sizeof(pwgen::DictNode), flat.size(), file) == flat.size() &&
+                  fwrite(targets.data(), sizeof(uint32_t), targets.size(), file) == targets.size() &&
+                  fwrite(labels.data(), 1, labels.size(), file) == labels.size() &&
+                  fwrite(names.data(), 1, names.size(), file) == names.size() &&
+                  fwrite(zeros, 1, padding, file) == padding;
+        return fclose(file) == 0 && ok;
+    }
+
+    size_t size() const { return nodes.size(); }
+
+private:
+    std::vector<TrieNode> nodes;
+};
+
+void usage() {
+    std::cerr << "Usage: pwdictc -o OUTPUT name=wordlist.txt [name=wordlist.txt ...]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::vector<std::string> names;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            size_t eq = arg.find('=');
+            if (eq == std::string::npos || eq == 0 || eq + 1 == arg.size()) {
+                usage();
+                return 1;
+            }
+            names.push_back(arg.substr(0, eq));
+            paths.push_back(arg.substr(eq + 1));
+        }
+    }
+    if (output.empty() || paths.empty()) {
+        usage();
+        return 1;
+    }
+    if (paths.size() > pwgen::DICT_MAX_LISTS) {
+        std::cerr << "Error: at most " << pwgen::DICT_MAX_LISTS << " wordlists." << std::endl;
+        return 1;
+    }
+
+    TrieBuilder trie;
+    uint32_t words = 0;
+    for (size_t list = 0; list < paths.size(); list++) {
+        std::ifstream in(paths[list]);
+        if (!in) {
+            std::cerr << "Error: cannot read " << paths[list] << std::endl;
+            return 1;
+        }
+
+        uint32_t rank = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t end = line.find_first_of(" \t\r");
+            std::string word = line.substr(0, end);
+            if (word.empty() || word[0] == '#') continue;
+            rank++;
+            if (word.size() < MIN_WORD || word.size() > pwgen::DICT_MAX_WORD) continue;
+            for (char& c : word) {
+                c = static_cast<char>(pwgen::dictFold(static_cast<unsigned char>(c)));
+            }
+            if (trie.add(word, rank, static_cast<uint8_t>(list))) words++;
+        }
+    }
+
+    trie.link();
+    if (!trie.write(output, names, words)) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return 1;
+    }
+    std::cout << output << ": " << words << " words, " << trie.size() << " nodes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,152 @@
+// pwwordsc - compile a passphrase wordlist into the offset-indexed blob that
+// passphrase mode memory-maps (see ../wordlist.h for the format).
+//
+// Usage: pwwordsc -o pwgen.words wordlist.txt [wordlist.txt ...]
+//
+// One word per line; EFF diceware lists ("11111<TAB>abacus") work as is, the
+// dice roll column is dropped. Lines starting with '#' are comments. Words
+// must be free of whitespace and control characters. Duplicates are dropped,
+// since every word has to be equally likely for the entropy to hold.
+//
+// Build: g++ -O2 -std=c++11 -o pwwordsc libpwgen/dict/pwwordsc.cpp
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../wordlist.h"
+
+namespace {
+
+bool isDiceRoll(const std::string& token) {
+    if (token.empty()) return false;
+    for (char c : token) {
+        if (c < '1' || c > '6') return false;
+    }
+    return true;
+}
+
+bool validWord(const std::string& word) {
+    for (unsigned char c : word) {
+        if (c <= ' ' || c == 0x7f) return false;
+    }
+    return !word.empty() && word.size() <= pwgen::WORDS_MAX_WORD;
+}
+
+bool write(const std::string& path, const std::vector<std::string>& words) {
+    std::vector<uint32_t> offsets(1, 0);
+    std::string text;
+    uint32_t maxWord = 0;
+    for (const std::string& word : words) {
+        text += word;
+        offsets.push_back(static_cast<uint32_t>(text.size()));
+        if (word.size() > maxWord) maxWord = static_cast<uint32_t>(word.size());
+    }
+
+    pwgen::WordsHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, pwgen::WORDS_MAGIC, sizeof(header.magic));
+    header.version = pwgen::WORDS_VERSION;
+    header.byteOrder = pwgen::WORDS_BYTE_ORDER;
+    header.wordCount = static_cast<uint32_t>(words.size());
+    header.bytesSize = static_cast<uint32_t>(text.size());
+    header.maxWord = maxWord;
+
+    size_t total = sizeof(header) + offsets.size() * sizeof(uint32_t) + text.size();
+    size_t padding = (4 - total % 4) % 4;
+    header.totalSize = static_cast<uint32_t>(total + padding);
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    const char zeros[4] = { 0, 0, 0, 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), file) == offsets.size() &&
+              fwrite(text.data(), 1, text.size(), file) == text.size() &&
+              fwrite(zeros, 1, padding, file) == padding;
+    return fclose(file) == 0 && ok;
+}
+
+void usage() {
+    std::cerr << "Usage: pwwordsc -o OUTPUT wordlist.txt [wordlist.txt ...]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string output;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (output.empty() || paths.empty()) {
+        usage();
+        return 1;
+    }
+
+    std::vector<std::string> words;
+    std::unordered_set<std::string> seen;
+    size_t duplicates = 0;
+    for (const std::string& path : paths) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Error: cannot read " << path << std::endl;
+            return 1;
+        }
+
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line[start] == '#') continue;
+            size_t end = line.find_first_of(" \t", start);
+            std::string word = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+            // EFF format: the dice roll, then the word
+            if (isDiceRoll(word) && end != std::string::npos) {
+                size_t next = line.find_first_not_of(" \t", end);
+                if (next != std::string::npos) {
+                    word = line.substr(next);
+                    size_t trail = word.find_last_not_of(" \t");
+                    word.erase(trail + 1);
+                }
+            } else if (end != std::string::npos && line.find_first_not_of(" \t", end) != std::string::npos) {
+                word.clear();   // more than one token: reject below
+            }
+
+            if (!validWord(word)) {
+                std::cerr << "Error: " << path << ":" << lineNumber << ": not a single word" << std::endl;
+                return 1;
+            }
+            if (!seen.insert(word).second) {
+                duplicates++;
+                continue;
+            }
+            words.push_back(word);
+        }
+    }
+
+    if (words.size() < 2) {
+        std::cerr << "Error: a wordlist needs at least two words." << std::endl;
+        return 1;
+    }
+    if (!write(output, words)) {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return 1;
+    }
+    std::cout << output << ": " << words.size() << " words";
+    if (duplicates) std::cout << " (" << duplicates << " duplicates dropped)";
+    std::cout << std::endl;
+    return 0;
+}
@@ -0,0 +1,267 @@
+#ifndef PWGEN_DICTIONARY_H
+#define PWGEN_DICTIONARY_H
+
+// Memory-mapped dictionary automaton for the strength estimator.
+//
+// Wordlists are compiled ahead of time by dict/pwdictc.cpp into one flat
+// Aho-Corasick blob: nodes in breadth-first order, each with a sorted edge
+// range, a failure link and a link to the nearest word ending on its suffix
+// chain. At runtime the file is mapped read-only and walked in place, so
+// opening a dictionary costs one mmap() and a bounds check, and matching every
+// word in a password is one pass over its bytes.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef PWGEN_DICT_DIR
+#define PWGEN_DICT_DIR "/usr/share/pwgen"
+#endif
+
+namespace pwgen {
+
+const char DICT_MAGIC[8] = { 'P', 'W', 'D', 'I', 'C', 'T', '\0', '\1' };
+const uint32_t DICT_VERSION = 1;
+const uint32_t DICT_BYTE_ORDER = 0x01020304;
+const size_t DICT_MAX_WORD = 32;
+const size_t DICT_MAX_LISTS = 16;
+
+// File layout: DictHeader, DictNode[nodeCount], uint32_t targets[edgeCount],
+// uint8_t labels[edgeCount], list names (NUL-separated), padding to 4 bytes.
+struct DictHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;   // DICT_BYTE_ORDER as written by the compiler
+    uint32_t nodeCount;   // node 0 is the root
+    uint32_t edgeCount;
+    uint32_t listCount;   // wordlists merged into the automaton
+    uint32_t namesSize;   // bytes of list names
+    uint32_t wordCount;
+    uint32_t totalSize;   // whole file
+};
+
+struct DictNode {
+    uint32_t firstEdge;
+    uint32_t fail;        // longest proper suffix that is also a trie node
+    uint32_t output;      // nearest word-ending node on the fail chain, 0 if none
+    uint32_t rank;        // 1-based rank in its list if a word ends here, else 0
+    uint16_t edgeCount;
+    uint8_t list;         // list index of the best-ranked word ending here
+    uint8_t depth;        // distance from the root, the word length where a word ends
+};
+
+// ASCII lowercase fold used both when compiling and when matching
+inline unsigned char dictFold(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+}
+
+class Dictionary {
+public:
+    Dictionary() {}
+
+    ~Dictionary() { close(); }
+
+    // Map a compiled dictionary; false (and an empty dictionary) if the file
+    // is missing or malformed
+    bool open(const std::string& path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(DictHeader))) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const unsigned char*>(mapped);
+        size = static_cast<size_t>(st.st_size);
+        isMapped = true;
+#else
+        // No mmap(): read the blob into one buffer, still without parsing it
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        unsigned char chunk[65536];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            copy.insert(copy.end(), chunk, chunk + got);
+        }
+        fclose(file);
+        base = copy.data();
+        size = copy.size();
+#endif
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (isMapped) munmap(const_cast<unsigned char*>(base), size);
+#endif
+        isMapped = false;
+        copy.clear();
+        base = nullptr;
+        size = 0;
+        header = nullptr;
+        nodes = nullptr;
+        targets = nullptr;
+        labels = nullptr;
+        listNames.clear();
+    }
+
+    bool empty() const { return header == nullptr; }
+
+    size_t wordCount() const { return header ? header->wordCount : 0; }
+
+    size_t listCount() const { return listNames.size(); }
+
+    const char* listName(size_t list) const {
+        return list < listNames.size() ? listNames[list] : "";
+    }
+
+    // Report every dictionary word in `text` (already folded) as
+    // onMatch(first, last, rank, list), with inclusive byte positions.
+    template <typename Callback>
+    void match(const unsigned char* text, size_t length, Callback onMatch) const {
+        if (!header) return;
+        uint32_t state = 0;
+        for (size_t pos = 0; pos < length; pos++) {
+            unsigned char c = text[pos];
+            uint32_t next;
+            while (!child(state, c, next) && state != 0) {
+                state = nodes[state].fail;
+            }
+            state = child(state, c, next) ? next : 0;
+
+            uint32_t out = nodes[state].rank ? state : nodes[state].output;
+            while (out != 0) {
+                const DictNode& node = nodes[out];
+                onMatch(pos + 1 - node.depth, pos, node.rank, node.list);
+                out = node.output;
+            }
+        }
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    bool isMapped = false;
+    std::vector<unsigned char> copy;
+
+    const DictHeader* header = nullptr;
+    const DictNode* nodes = nullptr;
+    const uint32_t* targets = nullptr;
+    const uint8_t* labels = nullptr;
+    std::vector<const char*> listNames;
+
+    Dictionary(const Dictionary&);
+    Dictionary& operator=(const Dictionary&);
+
+    bool child(uint32_t state, unsigned char c, uint32_t& next) const {
+        const DictNode& node = nodes[state];
+        const uint8_t* first = labels + node.firstEdge;
+        size_t lo = 0, hi = node.edgeCount;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (first[mid] < c) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo < node.edgeCount && first[lo] == c) {
+            next = targets[node.firstEdge + lo];
+            return true;
+        }
+        return false;
+    }
+
+    // Bounds-check the blob once so matching can trust every index
+    bool validate() {
+        const DictHeader* h = reinterpret_cast<const DictHeader*>(base);
+        if (memcmp(h->magic, DICT_MAGIC, sizeof(DICT_MAGIC)) != 0) return false;
+        if (h->version != DICT_VERSION || h->byteOrder != DICT_BYTE_ORDER) return false;
+        if (h->totalSize != size || h->nodeCount == 0 || h->listCount > DICT_MAX_LISTS) return false;
+
+        uint64_t needed = sizeof(DictHeader) + uint64_t(h->nodeCount) * sizeof(DictNode) +
+                          uint64_t(h->edgeCount) * 5 + h->namesSize;
+        if (needed > size) return false;
+
+        const DictNode* n = reinterpret_cast<const DictNode*>(base + sizeof(DictHeader));
+        const uint32_t* t = reinterpret_cast<const uint32_t*>(n + h->nodeCount);
+        const uint8_t* l = reinterpret_cast<const uint8_t*>(t + h->edgeCount);
+        const char* names = reinterpret_cast<const char*>(l + h->edgeCount);
+
+        for (uint32_t i = 0; i < h->nodeCount; i++) {
+            if (uint64_t(n[i].firstEdge) + n[i].edgeCount > h->edgeCount) return false;
+            if (n[i].fail >= h->nodeCount || n[i].output >= h->nodeCount) return false;
+            if (n[i].depth > DICT_MAX_WORD || n[i].list >= h->listCount) return false;
+            // Links must lead strictly towards the root, or matching could loop
+            if (i != 0 && n[n[i].fail].depth >= n[i].depth) return false;
+            if (n[i].output != 0 && n[n[i].output].depth >= n[i].depth) return false;
+        }
+        for (uint32_t e = 0; e < h->edgeCount; e++) {
+            if (t[e] >= h->nodeCount || t[e] == 0) return false;
+        }
+        if (h->namesSize == 0 || names[h->namesSize - 1] != '\0') return false;
+        for (const char* p = names; p < names + h->namesSize; p += strlen(p) + 1) {
+            listNames.push_back(p);
+        }
+        if (listNames.size() != h->listCount) return false;
+
+        header = h;
+        nodes = n;
+        targets = t;
+        labels = l;
+        return true;
+    }
+};
+
+// Path of `name` next to the running executable, if known
+inline std::string executableSiblingPath(const char* name) {
+#if defined(__linux__)
+    char exe[4096];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (len > 0) {
+        std::string path(exe, static_cast<size_t>(len));
+        size_t slash = path.rfind('/');
+        if (slash != std::string::npos) return path.substr(0, slash + 1) + name;
+    }
+#endif
+    return std::string();
+}
+
+// Process-wide dictionary, mapped on first use from $PWGEN_DICT, then
+// pwgen.dict beside the executable, then PWGEN_DICT_DIR. Stays empty if none
+// of them exists; the estimator then runs without dictionary matches.
+inline const Dictionary& defaultDictionary() {
+    struct Loader {
+        Dictionary dictionary;
+        Loader() {
+            const char* env = getenv("PWGEN_DICT");
+            if (env && *env && dictionary.open(env)) return;
+            std::string beside = executableSiblingPath("pwgen.dict");
+            if (!beside.empty() && dictionary.open(beside)) return;
+            dictionary.open(PWGEN_DICT_DIR "/pwgen.dict");
+        }
+    };
+    static const Loader loader;
+    return loader.dictionary;
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_DICTIONARY_H
@@ -0,0 +1,760 @@
+#ifndef PWGEN_ESTIMATOR_H
+#define PWGEN_ESTIMATOR_H
+
+// Pattern-matching strength estimator after zxcvbn (Wheeler, "zxcvbn:
+// Low-Budget Password Strength Estimation", USENIX Security 2016).
+//
+// Every dictionary word (plain, reversed and l33t), keyboard walk, repeat,
+// character sequence and date found in the password becomes a match with a
+// guess count. A dynamic program over the match graph then picks the sequence
+// of non-overlapping matches, with bruteforce filling the gaps, that an
+// attacker would need the fewest guesses for. All guess counts are kept as
+// log10 so long passwords don't overflow.
+//
+// Cost is dominated by the dynamic program, so longer passwords are analysed
+// in ESTIMATE_MAX_LENGTH-character windows whose guesses multiply.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "dictionary.h"
+#include "strength.h"
+
+namespace pwgen {
+
+const size_t ESTIMATE_MAX_LENGTH = 64;
+
+enum class Pattern : uint8_t {
+    Bruteforce,
+    Dictionary,
+    Spatial,
+    Repeat,
+    Sequence,
+    Date,
+    Year,
+};
+
+inline const char* patternName(Pattern pattern) {
+    switch (pattern) {
+        case Pattern::Bruteforce: return "bruteforce";
+        case Pattern::Dictionary: return "dictionary";
+        case Pattern::Spatial: return "spatial";
+        case Pattern::Repeat: return "repeat";
+        case Pattern::Sequence: return "sequence";
+        case Pattern::Date: return "date";
+        case Pattern::Year: return "year";
+    }
+    return "unknown";
+}
+
+struct Match {
+    uint32_t first;         // inclusive byte positions
+    uint32_t last;
+    Pattern pattern;
+    uint8_t list;           // dictionary list index
+    bool reversed;
+    bool l33t;
+    uint32_t rank;          // dictionary rank
+    double guessesLog10;    // guesses for the pattern alone
+};
+
+struct Estimate {
+    double guessesLog10 = 0;
+    int score = 0;                  // 0-100
+    std::vector<Match> sequence;    // cheapest covering sequence, in order
+};
+
+// 0-100 score: 5 points per decade of guesses, so 10^6 guesses is the
+// Weak/Very Weak boundary (30) and 10^18 reaches Very Strong (90)
+inline int scoreFromGuesses(double guessesLog10) {
+    double score = 5.0 * guessesLog10;
+    if (score <= 0) return 0;
+    return std::min(100, static_cast<int>(score + 0.5));
+}
+
+namespace detail {
+
+const double MIN_GUESSES_BEFORE_GROWING_SEQUENCE_LOG10 = 4;  // 10000
+const double MIN_SUBMATCH_GUESSES_SINGLE_CHAR = 10;
+const double MIN_SUBMATCH_GUESSES_MULTI_CHAR = 50;
+const int MIN_YEAR_SPACE = 20;
+const int DATE_MIN_YEAR = 1000;
+const int DATE_MAX_YEAR = 2050;
+const int MAX_SEQUENCE_DELTA = 5;
+
+inline double binomial(unsigned int n, unsigned int k) {
+    if (k > n) return 0;
+    k = std::min(k, n - k);
+    double result = 1;
+    for (unsigned int i = 1; i <= k; i++) {
+        result = result * (n - k + i) / i;
+    }
+    return result;
+}
+
+inline bool isDigit(unsigned char c) { return c >= '0' && c <= '9'; }
+inline bool isUpper(unsigned char c) { return c >= 'A' && c <= 'Z'; }
+inline bool isLower(unsigned char c) { return c >= 'a' && c <= 'z'; }
+
+inline Match makeMatch(size_t first, size_t last, Pattern pattern, double guessesLog10) {
+    Match match;
+    match.first = static_cast<uint32_t>(first);
+    match.last = static_cast<uint32_t>(last);
+    match.pattern = pattern;
+    match.list = 0;
+    match.reversed = false;
+    match.l33t = false;
+    match.rank = 0;
+    match.guessesLog10 = guessesLog10;
+    return match;
+}
+
+// Keyboard adjacency built from row strings of (unshifted, shifted) pairs;
+// "  " is an empty slot. Keys in neighbouring rows are adjacent when their
+// horizontal centres are at most one key apart.
+class KeyboardGraph {
+public:
+    KeyboardGraph(const char* const* rows, const double* offsets, size_t rowCount) {
+        std::fill(keyOf, keyOf + 128, static_cast<uint8_t>(0));
+        std::fill(shiftedOf, shiftedOf + 128, false);
+        for (size_t r = 0; r < rowCount; r++) {
+            const char* row = rows[r];
+            for (size_t c = 0; row[2 * c] != '\0'; c++) {
+                char plain = row[2 * c];
+                char shifted = row[2 * c + 1];
+                if (plain == ' ') continue;
+                keyRow[keys] = static_cast<int>(r);
+                keyX[keys] = offsets[r] + static_cast<double>(c);
+                keys++;
+                keyOf[static_cast<unsigned char>(plain)] = static_cast<uint8_t>(keys);
+                if (shifted != ' ') {
+                    keyOf[static_cast<unsigned char>(shifted)] = static_cast<uint8_t>(keys);
+                    shiftedOf[static_cast<unsigned char>(shifted)] = true;
+                }
+            }
+        }
+
+        size_t edges = 0;
+        for (size_t a = 0; a < keys; a++) {
+            for (size_t b = 0; b < keys; b++) {
+                int dr = keyRow[b] - keyRow[a];
+                double dx = keyX[b] - keyX[a];
+                bool adjacent = (dr == 0 && fabs(dx) == 1.0) ||
+                                ((dr == 1 || dr == -1) && fabs(dx) <= 1.0);
+                int sx = dx > 0.01 ? 1 : (dx < -0.01 ? -1 : 0);
+                direction[a][b] = adjacent ? static_cast<uint8_t>((dr + 1) * 3 + (sx + 1) + 1) : 0;
+                if (adjacent) edges++;
+            }
+        }
+        startingPositions = static_cast<double>(keys);
+        averageDegree = keys ? static_cast<double>(edges) / keys : 0;
+    }
+
+    // Direction code from a to b (1..9), 0 if not adjacent or not on this keyboard
+    uint8_t step(unsigned char a, unsigned char b) const {
+        if (a >= 128 || b >= 128 || !keyOf[a] || !keyOf[b]) return 0;
+        return direction[keyOf[a] - 1][keyOf[b] - 1];
+    }
+
+    bool shifted(unsigned char c) const { return c < 128 && shiftedOf[c]; }
+
+    // zxcvbn's spatial guesses for a walk of `length` keys with `turns`
+    // direction changes and `shiftedCount` shifted characters
+    double guessesLog10(size_t length, size_t turns, size_t shiftedCount) const {
+        double guesses = 0;
+        for (size_t i = 2; i <= length; i++) {
+            size_t possibleTurns = std::min(turns, i - 1);
+            for (size_t j = 1; j <= possibleTurns; j++) {
+                guesses += binomial(static_cast<unsigned int>(i - 1), static_cast<unsigned int>(j - 1)) *
+                           startingPositions * pow(averageDegree, static_cast<double>(j));
+            }
+        }
+        if (shiftedCount > 0) {
+            size_t unshifted = length - shiftedCount;
+            if (unshifted == 0) {
+                guesses *= 2;
+            } else {
+                double variations = 0;
+                for (size_t i = 1; i <= std::min(shiftedCount, unshifted); i++) {
+                    variations += binomial(static_cast<unsigned int>(length), static_cast<unsigned int>(i));
+                }
+                guesses *= variations;
+            }
+        }
+        return log10(std::max(guesses, 1.0));
+    }
+
+private:
+    uint8_t keyOf[128];
+    bool shiftedOf[128];
+    int keyRow[96];
+    double keyX[96];
+    uint8_t direction[96][96];
+    size_t keys = 0;
+    double startingPositions = 0;
+    double averageDegree = 0;
+};
+
+inline const KeyboardGraph& qwertyGraph() {
+    static const char* const rows[] = {
+        "`~1!2@3#4$5%6^7&8*9(0)-_=+",
+        "qQwWeErRtTyYuUiIoOpP[{]}\\|",
+        "aAsSdDfFgGhHjJkKlL;:'\"",
+        "zZxXcCvVbBnNmM,<.>/?",
+    };
+    static const double offsets[] = { 0, 1.5, 1.75, 2.25 };
+    static const KeyboardGraph graph(rows, offsets, 4);
+    return graph;
+}
+
+inline const KeyboardGraph& keypadGraph() {
+    static const char* const rows[] = {
+        "  / * - ",
+        "7 8 9 + ",
+        "4 5 6 ",
+        "1 2 3 ",
+        "0   . ",
+    };
+    static const double offsets[] = { 0, 0, 0, 0, 0 };
+    static const KeyboardGraph graph(rows, offsets, 5);
+    return graph;
+}
+
+// l33t substitutions; ambiguous symbols get one reading per table
+struct L33tTable {
+    unsigned char to[256];
+
+    explicit L33tTable(bool preferL) {
+        for (int c = 0; c < 256; c++) to[c] = static_cast<unsigned char>(c);
+        to['4'] = 'a'; to['@'] = 'a';
+        to['8'] = 'b';
+        to['('] = 'c'; to['{'] = 'c'; to['['] = 'c'; to['<'] = 'c';
+        to['3'] = 'e';
+        to['6'] = 'g'; to['9'] = 'g';
+        to['!'] = 'i';
+        to['0'] = 'o';
+        to['$'] = 's'; to['5'] = 's';
+        to['+'] = 't';
+        to['%'] = 'x';
+        to['2'] = 'z';
+        to['1'] = preferL ? 'l' : 'i';
+        to['|'] = preferL ? 'l' : 'i';
+        to['7'] = preferL ? 'l' : 't';
+    }
+};
+
+inline const L33tTable& l33tTable(bool preferL) {
+    static const L33tTable readI(false);
+    static const L33tTable readL(true);
+    return preferL ? readL : readI;
+}
+
+// Capitalisation variants an attacker tries for a dictionary word
+inline double uppercaseVariations(const unsigned char* token, size_t length) {
+    size_t upper = 0, lower = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (isUpper(token[i])) upper++;
+        else if (isLower(token[i])) lower++;
+    }
+    if (upper == 0) return 1;
+    if (lower == 0) return 2;
+    if (upper == 1 && (isUpper(token[0]) || isUpper(token[length - 1]))) return 2;
+
+    double variations = 0;
+    for (size_t i = 1; i <= std::min(upper, lower); i++) {
+        variations += binomial(static_cast<unsigned int>(upper + lower), static_cast<unsigned int>(i));
+    }
+    return variations;
+}
+
+// Substitution variants for a l33t match: per substituted letter, every way of
+// choosing which of its occurrences are substituted
+inline double l33tVariations(const unsigned char* folded, const unsigned char* unl33t, size_t length) {
+    double variations = 1;
+    bool seen[256] = { false };
+    for (size_t i = 0; i < length; i++) {
+        unsigned char symbol = folded[i];
+        if (symbol == unl33t[i] || seen[symbol]) continue;
+        seen[symbol] = true;
+
+        unsigned char letter = unl33t[i];
+        size_t subbed = 0, unsubbed = 0;
+        for (size_t k = 0; k < length; k++) {
+            if (folded[k] == symbol) subbed++;
+            else if (folded[k] == letter) unsubbed++;
+        }
+        if (unsubbed == 0) {
+            variations *= 2;
+        } else {
+            double sum = 0;
+            for (size_t k = 1; k <= std::min(subbed, unsubbed); k++) {
+                sum += binomial(static_cast<unsigned int>(subbed + unsubbed), static_cast<unsigned int>(k));
+            }
+            variations *= sum;
+        }
+    }
+    return variations;
+}
+
+inline void matchDictionary(const Dictionary& dictionary, const unsigned char* password, size_t n,
+                            std::vector<Match>& matches) {
+    if (dictionary.empty()) return;
+
+    unsigned char folded[ESTIMATE_MAX_LENGTH];
+    unsigned char reversed[ESTIMATE_MAX_LENGTH];
+    for (size_t i = 0; i < n; i++) {
+        folded[i] = dictFold(password[i]);
+        reversed[n - 1 - i] = folded[i];
+    }
+
+    dictionary.match(folded, n, [&](size_t first, size_t last, uint32_t rank, uint8_t list) {
+        double variations = uppercaseVariations(password + first, last - first + 1);
+        Match match = makeMatch(first, last, Pattern::Dictionary, log10(rank * variations));
+        match.rank = rank;
+        match.list = list;
+        matches.push_back(match);
+    });
+
+    dictionary.match(reversed, n, [&](size_t first, size_t last, uint32_t rank, uint8_t list) {
+        size_t start = n - 1 - last;
+        size_t end = n - 1 - first;
+        double variations = uppercaseVariations(password + start, end - start + 1);
+        Match match = makeMatch(start, end, Pattern::Dictionary, log10(rank * variations * 2));
+        match.rank = rank;
+        match.list = list;
+        match.reversed = true;
+        matches.push_back(match);
+    });
+
+    for (int preferL = 0; preferL < 2; preferL++) {
+        const L33tTable& table = l33tTable(preferL != 0);
+        unsigned char unl33t[ESTIMATE_MAX_LENGTH];
+        bool substituted = false;
+        for (size_t i = 0; i < n; i++) {
+            unl33t[i] = table.to[folded[i]];
+            substituted = substituted || unl33t[i] != folded[i];
+        }
+        if (!substituted) continue;
+
+        dictionary.match(unl33t, n, [&](size_t first, size_t last, uint32_t rank, uint8_t list) {
+            size_t length = last - first + 1;
+            if (std::equal(unl33t + first, unl33t + last + 1, folded + first)) return; // plain match
+            double variations = uppercaseVariations(password + first, length) *
+                                l33tVariations(folded + first, unl33t + first, length);
+            Match match = makeMatch(first, last, Pattern::Dictionary, log10(rank * variations));
+            match.rank = rank;
+            match.list = list;
+            match.l33t = true;
+            matches.push_back(match);
+        });
+    }
+}
+
+inline void matchSpatial(const KeyboardGraph& graph, const unsigned char* password, size_t n,
+                         std::vector<Match>& matches) {
+    size_t i = 0;
+    while (i + 2 < n) {
+        size_t j = i;
+        size_t turns = 0;
+        size_t shiftedCount = graph.shifted(password[i]) ? 1 : 0;
+        uint8_t lastDirection = 0;
+        while (j + 1 < n) {
+            uint8_t direction = graph.step(password[j], password[j + 1]);
+            if (!direction) break;
+            if (direction != lastDirection) turns++;
+            lastDirection = direction;
+            if (graph.shifted(password[j + 1])) shiftedCount++;
+            j++;
+        }
+        if (j - i + 1 >= 3) {
+            matches.push_back(makeMatch(i, j, Pattern::Spatial,
+                                        graph.guessesLog10(j - i + 1, turns, shiftedCount)));
+        }
+        i = j + 1;
+    }
+}
+
+inline void matchSequence(const unsigned char* password, size_t n, std::vector<Match>& matches) {
+    if (n < 2) return;
+
+    auto emit = [&](size_t first, size_t last, int delta) {
+        int magnitude = delta < 0 ? -delta : delta;
+        if (last - first + 1 < 3 || magnitude == 0 || magnitude > MAX_SEQUENCE_DELTA) return;
+        unsigned char start = password[first];
+        double base;
+        if (start == 'a' || start == 'A' || start == 'z' || start == 'Z' ||
+            start == '0' || start == '1' || start == '9') {
+            base = 4;  // obvious starting points
+        } else if (isDigit(start)) {
+            base = 10;
+        } else {
+            base = 26;
+        }
+        if (delta < 0) base *= 2;
+        matches.push_back(makeMatch(first, last, Pattern::Sequence,
+                                    log10(base * static_cast<double>(last - first + 1))));
+    };
+
+    size_t first = 0;
+    int lastDelta = static_cast<int>(password[1]) - static_cast<int>(password[0]);
+    for (size_t k = 2; k < n; k++) {
+        int delta = static_cast<int>(password[k]) - static_cast<int>(password[k - 1]);
+        if (delta == lastDelta) continue;
+        emit(first, k - 1, lastDelta);
+        first = k - 1;
+        lastDelta = delta;
+    }
+    emit(first, n - 1, lastDelta);
+}
+
+inline int referenceYear() {
+    time_t now = time(nullptr);
+    struct tm parts;
+#if defined(_WIN32)
+    gmtime_s(&parts, &now);
+#else
+    gmtime_r(&now, &parts);
+#endif
+    return parts.tm_year + 1900;
+}
+
+inline bool mapIntsToDayMonth(int a, int b) {
+    return (a >= 1 && a <= 31 && b >= 1 && b <= 12) || (b >= 1 && b <= 31 && a >= 1 && a <= 12);
+}
+
+inline int twoToFourDigitYear(int year) {
+    if (year > 99) return year;
+    if (year > 50) return year + 1900;
+    return year + 2000;
+}
+
+// Year of a plausible day/month/year reading of three numbers, or 0
+inline int mapIntsToYear(const int ints[3]) {
+    if (ints[1] > 31 || ints[1] <= 0) return 0;
+    int over12 = 0, over31 = 0, under1 = 0;
+    for (int k = 0; k < 3; k++) {
+        int value = ints[k];
+        if ((value > 99 && value < DATE_MIN_YEAR) || value > DATE_MAX_YEAR) return 0;
+        if (value > 31) over31++;
+        if (value > 12) over12++;
+        if (value <= 0) under1++;
+    }
+    if (over31 >= 2 || over12 == 3 || under1 >= 2) return 0;
+
+    // Year last or year first
+    const int years[2] = { ints[2], ints[0] };
+    const int rest[2][2] = { { ints[0], ints[1] }, { ints[1], ints[2] } };
+    for (int k = 0; k < 2; k++) {
+        if (years[k] >= DATE_MIN_YEAR && years[k] <= DATE_MAX_YEAR) {
+            return mapIntsToDayMonth(rest[k][0], rest[k][1]) ? years[k] : 0;
+        }
+    }
+    for (int k = 0; k < 2; k++) {
+        if (mapIntsToDayMonth(rest[k][0], rest[k][1])) return twoToFourDigitYear(years[k]);
+    }
+    return 0;
+}
+
+inline int parseDigits(const unsigned char* text, size_t length) {
+    int value = 0;
+    for (size_t i = 0; i < length; i++) value = value * 10 + (text[i] - '0');
+    return value;
+}
+
+inline double dateGuessesLog10(int year, int reference, bool separator) {
+    int space = std::max(std::abs(year - reference), MIN_YEAR_SPACE);
+    return log10(space * 365.0 * (separator ? 4 : 1));
+}
+
+inline void matchDates(const unsigned char* password, size_t n, std::vector<Match>& matches) {
+    const int reference = referenceYear();
+
+    // Bare recent years
+    for (size_t i = 0; i + 4 <= n; i++) {
+        if (!std::all_of(password + i, password + i + 4, isDigit)) continue;
+        int year = parseDigits(password + i, 4);
+        if (year >= 1900 && year <= 2099) {
+            int space = std::max(std::abs(year - reference), MIN_YEAR_SPACE);
+            matches.push_back(makeMatch(i, i + 3, Pattern::Year, log10(static_cast<double>(space))));
+        }
+    }
+
+    // 4-8 digits without separators, split every way zxcvbn does
+    static const uint8_t splits[9][4][2] = {
+        {}, {}, {}, {},
+        { { 1, 2 }, { 2, 3 } },
+        { { 1, 3 }, { 2, 3 } },
+        { { 1, 2 }, { 2, 4 }, { 4, 5 } },
+        { { 1, 3 }, { 2, 3 }, { 4, 5 }, { 4, 6 } },
+        { { 2, 4 }, { 4, 6 } },
+    };
+    for (size_t i = 0; i + 4 <= n; i++) {
+        for (size_t length = 4; length <= 8 && i + length <= n; length++) {
+            const unsigned char* token = password + i;
+            if (!std::all_of(token, token + length, isDigit)) break;
+
+            int best = 0;
+            for (size_t s = 0; s < 4 && splits[length][s][0] != 0; s++) {
+                size_t k = splits[length][s][0], l = splits[length][s][1];
+                int ints[3] = { parseDigits(token, k), parseDigits(token + k, l - k),
+                                parseDigits(token + l, length - l) };
+                int year = mapIntsToYear(ints);
+                if (year && (!best || std::abs(year - reference) < std::abs(best - reference))) {
+                    best = year;
+                }
+            }
+            if (best) {
+                matches.push_back(makeMatch(i, i + length - 1, Pattern::Date,
+                                            dateGuessesLog10(best, reference, false)));
+            }
+        }
+    }
+
+    // d-m-y with one repeated separator: 1-4 digits, sep, 1-2 digits, sep, 1-4 digits
+    for (size_t i = 0; i + 6 <= n; i++) {
+        size_t a = i;
+        while (a < n && a - i < 4 && isDigit(password[a])) a++;
+        if (a == i || a >= n) continue;
+        unsigned char sep = password[a];
+        if (!(sep == ' ' || sep == '/' || sep == '\\' || sep == '_' || sep == '.' || sep == '-')) continue;
+        size_t b = a + 1;
+        while (b < n && b - a - 1 < 2 && isDigit(password[b])) b++;
+        if (b == a + 1 || b >= n || password[b] != sep) continue;
+        for (size_t c = b + 1; c < n && c - b <= 4 && isDigit(password[c]); c++) {
+            int ints[3] = { parseDigits(password + i, a - i), parseDigits(password + a + 1, b - a - 1),
+                            parseDigits(password + b + 1, c - b) };
+            int year = mapIntsToYear(ints);
+            if (year) {
+                matches.push_back(makeMatch(i, c, Pattern::Date, dateGuessesLog10(year, reference, true)));
+            }
+        }
+    }
+}
+
+inline double estimateLog10(const Dictionary& dictionary, const unsigned char* password, size_t n,
+                            std::vector<Match>* sequence);
+
+// Repeated substrings ("aaa", "abcabc"), scored as the base's own guesses
+// times the repeat count
+inline void matchRepeats(const Dictionary& dictionary, const unsigned char* password, size_t n,
+                         std::vector<Match>& matches) {
+    size_t i = 0;
+    while (i + 1 < n) {
+        size_t bestBase = 0, bestCount = 0;
+        for (size_t base = 1; i + 2 * base <= n; base++) {
+            size_t count = 1;
+            while (i + (count + 1) * base <= n &&
+                   std::equal(password + i, password + i + base, password + i + count * base)) {
+                count++;
+            }
+            if (count >= 2 && base * count > bestBase * bestCount) {
+                bestBase = base;
+                bestCount = count;
+            }
+        }
+        if (bestBase == 0 || (bestBase == 1 && bestCount < 3)) {
+            i++;
+            continue;
+        }
+        double baseGuesses = estimateLog10(dictionary, password + i, bestBase, nullptr);
+        size_t last = i + bestBase * bestCount - 1;
+        matches.push_back(makeMatch(i, last, Pattern::Repeat,
+                                    baseGuesses + log10(static_cast<double>(bestCount))));
+        i = last + 1;
+    }
+}
+
+// Guesses for a match as a step of the whole sequence: never below the
+// submatch minimums unless it covers the entire password
+inline double stepGuessesLog10(const Match& match, size_t n) {
+    size_t length = match.last - match.first + 1;
+    double minimum = 0;
+    if (length < n) {
+        minimum = log10(length == 1 ? MIN_SUBMATCH_GUESSES_SINGLE_CHAR : MIN_SUBMATCH_GUESSES_MULTI_CHAR);
+    }
+    return std::max(match.guessesLog10, minimum);
+}
+
+// Bruteforce over the alphabet of the classes a run actually uses
+inline double bruteforceGuessesLog10(uint8_t classes, size_t length) {
+    struct Table {
+        double log10Cardinality[CLASS_ALL + 1];
+        Table() {
+            log10Cardinality[0] = 0;
+            for (int c = 1; c <= CLASS_ALL; c++) {
+                log10Cardinality[c] = log10(classCardinality(static_cast<uint8_t>(c)));
+            }
+        }
+    };
+    static const Table table;
+    double guesses = static_cast<double>(length) * table.log10Cardinality[classes & CLASS_ALL];
+    double minimum = log10((length == 1 ? MIN_SUBMATCH_GUESSES_SINGLE_CHAR : MIN_SUBMATCH_GUESSES_MULTI_CHAR) + 1);
+    return std::max(guesses, minimum);
+}
+
+// Minimum-guesses match sequence (zxcvbn's most_guessable_match_sequence).
+// State [k][l] is the best sequence of l matches covering password[0..k]; its
+// cost is l! * product(guesses) + 10000^(l-1), so sequences with many small
+// pieces don't look artificially weak. With at most ESTIMATE_MAX_LENGTH
+// characters every cost stays well inside double range, so the program runs on
+// plain products and only the result goes back to log10.
+inline double estimateLog10(const Dictionary& dictionary, const unsigned char* password, size_t n,
+                            std::vector<Match>* sequence) {
+    if (n == 0) return 0;
+
+    std::vector<Match> matches;
+    matches.reserve(64);
+    matchDictionary(dictionary, password, n, matches);
+    matchSpatial(qwertyGraph(), password, n, matches);
+    matchSpatial(keypadGraph(), password, n, matches);
+    matchRepeats(dictionary, password, n, matches);
+    matchSequence(password, n, matches);
+    matchDates(password, n, matches);
+
+    std::sort(matches.begin(), matches.end(), [](const Match& a, const Match& b) {
+        return a.last != b.last ? a.last < b.last : a.first < b.first;
+    });
+
+    const double unset = std::numeric_limits<double>::infinity();
+    const size_t width = n + 1;
+    std::vector<double> bestG(n * width, unset);
+    std::vector<double> bestPi(n * width, unset);
+    std::vector<int> bestMatch(n * width, -1);
+    double factorial[ESTIMATE_MAX_LENGTH + 1];
+    double additive[ESTIMATE_MAX_LENGTH + 1];  // 10000^(l-1)
+    factorial[0] = 1;
+    additive[0] = 1;
+    for (size_t l = 1; l <= n; l++) {
+        factorial[l] = factorial[l - 1] * static_cast<double>(l);
+        additive[l] = l == 1 ? 1 : additive[l - 1] * pow(10.0, MIN_GUESSES_BEFORE_GROWING_SEQUENCE_LOG10);
+    }
+
+    // Step guesses of every match, as plain numbers
+    std::vector<double> steps;
+    steps.reserve(matches.size() + n * 2);
+    for (const Match& match : matches) {
+        steps.push_back(pow(10.0, stepGuessesLog10(match, n)));
+    }
+    auto addBruteforce = [&](size_t first, size_t last, double guessesLog10) {
+        Match match = makeMatch(first, last, Pattern::Bruteforce, guessesLog10);
+        matches.push_back(match);
+        steps.push_back(pow(10.0, stepGuessesLog10(match, n)));
+        return static_cast<int>(matches.size() - 1);
+    };
+
+    size_t longest[ESTIMATE_MAX_LENGTH] = {};   // highest l with a sequence ending at k
+
+    auto update = [&](int index, size_t l) {
+        const Match& match = matches[index];
+        size_t k = match.last;
+        double pi = steps[index];
+        if (l > 1) pi *= bestPi[(match.first - 1) * width + (l - 1)];
+        double g = factorial[l] * pi + additive[l];
+        for (size_t other = 1; other <= l; other++) {
+            if (bestMatch[k * width + other] >= 0 && bestG[k * width + other] <= g) return;
+        }
+        bestG[k * width + l] = g;
+        bestPi[k * width + l] = pi;
+        bestMatch[k * width + l] = index;
+        longest[k] = std::max(longest[k], l);
+    };
+
+    // Bruteforce matches are appended as needed, after the pattern matches
+    const size_t found = matches.size();
+    size_t next = 0;
+    for (size_t k = 0; k < n; k++) {
+        for (; next < found && matches[next].last == k; next++) {
+            int index = static_cast<int>(next);
+            size_t first = matches[next].first;
+            if (first == 0) {
+                update(index, 1);
+                continue;
+            }
+            for (size_t l = 1; l <= longest[first - 1]; l++) {
+                if (bestMatch[(first - 1) * width + l] >= 0) update(index, l + 1);
+            }
+        }
+
+        // Classes of password[i..k] for every i, for the bruteforce runs
+        uint8_t coverage[ESTIMATE_MAX_LENGTH];
+        uint8_t seen = 0;
+        for (size_t i = k + 1; i-- > 0;) {
+            seen |= classTable().bits[password[i]];
+            coverage[i] = seen;
+        }
+
+        // Bruteforce from the start, or from after any non-bruteforce match
+        update(addBruteforce(0, k, bruteforceGuessesLog10(coverage[0], k + 1)), 1);
+        for (size_t i = 1; i <= k; i++) {
+            int bruteforce = -1;
+            for (size_t l = 1; l <= longest[i - 1]; l++) {
+                int previous = bestMatch[(i - 1) * width + l];
+                if (previous < 0 || matches[previous].pattern == Pattern::Bruteforce) continue;
+                if (bruteforce < 0) {
+                    bruteforce = addBruteforce(i, k, bruteforceGuessesLog10(coverage[i], k - i + 1));
+                }
+                update(bruteforce, l + 1);
+            }
+        }
+    }
+
+    size_t bestL = 1;
+    for (size_t l = 1; l <= n; l++) {
+        if (bestMatch[(n - 1) * width + l] >= 0 && bestG[(n - 1) * width + l] < bestG[(n - 1) * width + bestL]) {
+            bestL = l;
+        }
+    }
+    double guesses = log10(bestG[(n - 1) * width + bestL]);
+
+    if (sequence) {
+        sequence->clear();
+        size_t k = n - 1, l = bestL;
+        for (;;) {
+            const Match& match = matches[bestMatch[k * width + l]];
+            sequence->push_back(match);
+            if (match.first == 0) break;
+            k = match.first - 1;
+            l--;
+        }
+        std::reverse(sequence->begin(), sequence->end());
+    }
+    return guesses;
+}
+
+} // namespace detail
+
+// Estimate how many guesses an attacker with wordlists and pattern rules
+// needs for `password`. Uses defaultDictionary() unless one is passed.
+inline Estimate estimateStrength(const char* password, size_t length,
+                                 const Dictionary& dictionary = defaultDictionary()) {
+    Estimate estimate;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(password);
+    std::vector<Match> window;
+    for (size_t start = 0; start < length; start += ESTIMATE_MAX_LENGTH) {
+        size_t n = std::min(length - start, ESTIMATE_MAX_LENGTH);
+        estimate.guessesLog10 += detail::estimateLog10(dictionary, bytes + start, n, &window);
+        for (Match& match : window) {
+            match.first += static_cast<uint32_t>(start);
+            match.last += static_cast<uint32_t>(start);
+            estimate.sequence.push_back(match);
+        }
+    }
+    estimate.score = scoreFromGuesses(estimate.guessesLog10);
+    return estimate;
+}
+
+inline Estimate estimateStrength(const std::string& password,
+                                 const Dictionary& dictionary = defaultDictionary()) {
+    return estimateStrength(password.data(), password.size(), dictionary);
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_ESTIMATOR_H
@@ -0,0 +1,100 @@
+#ifndef PWGEN_INDEX_SAMPLER_H
+#define PWGEN_INDEX_SAMPLER_H
+
+// Unbiased character-index sampling from bulk random bytes.
+//
+// Each index costs one random byte (plus rejections) instead of one 64-bit
+// draw, and a whole password's worth of bytes is pulled from the RandomSource
+// in a single fill() call.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "secure_random.h"
+
+namespace pwgen {
+
+// Maps random bytes to indices in [0, size) for alphabets of 1..256 symbols
+// using Lemire's multiply-shift: m = byte * size, index = m >> 8, and the
+// byte is rejected when the low 8 bits of m fall below (256 - size) % size.
+// Accepted indices are exactly uniform.
+class IndexSampler {
+public:
+    explicit IndexSampler(unsigned int alphabetSize) : n(alphabetSize) {
+        if (alphabetSize == 0 || alphabetSize > 256) {
+            throw std::invalid_argument("alphabet size must be between 1 and 256");
+        }
+        t = static_cast<uint8_t>((256 - alphabetSize) % alphabetSize);
+    }
+
+    unsigned int size() const { return n; }
+
+    // Low-byte rejection threshold
+    uint8_t threshold() const { return t; }
+
+    // Scalar kernel. Maps `count` random bytes into at most `capacity` indices,
+    // skipping rejected bytes; returns the number of indices written.
+    size_t map(const uint8_t* bytes, size_t count, uint8_t* indices, size_t capacity) const {
+        size_t written = 0;
+        for (size_t i = 0; i < count && written < capacity; i++) {
+            unsigned int m = bytes[i] * n;
+            if ((m & 0xFF) >= t) {
+                indices[written++] = static_cast<uint8_t>(m >> 8);
+            }
+        }
+        return written;
+    }
+
+    // Fill `count` indices, drawing random bytes from `source` in blocks
+    // sized to the expected acceptance rate.
+    void sample(RandomSource& source, uint8_t* indices, size_t count) const {
+        uint8_t block[512];
+        size_t touched = 0;
+        while (count > 0) {
+            size_t want = count + (count * t) / (256 - t) + 8;
+            want = std::min(want, sizeof(block));
+            source.fill(block, want);
+            touched = std::max(touched, want);
+            size_t got = map(block, want, indices, count);
+            indices += got;
+            count -= got;
+        }
+        secureZero(block, touched);
+    }
+
+private:
+    unsigned int n;
+    uint8_t t;
+};
+
+// Uniform integer in [0, bound) from four random bytes (Lemire, 32-bit)
+inline uint32_t uniformBelow(RandomSource& source, uint32_t bound) {
+    uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+    for (;;) {
+        uint32_t x;
+        source.fill(reinterpret_cast<unsigned char*>(&x), sizeof(x));
+        uint64_t m = static_cast<uint64_t>(x) * bound;
+        if (static_cast<uint32_t>(m) >= threshold) {
+            return static_cast<uint32_t>(m >> 32);
+        }
+    }
+}
+
+// Pick `k` distinct positions in [0, length), as a uniformly random ordered
+// tuple. Equivalent to where `k` prepended characters land after a uniform
+// shuffle, without drawing randomness for every position.
+inline void choosePositions(RandomSource& source, size_t length, size_t k, size_t* positions) {
+    for (size_t i = 0; i < k; i++) {
+        size_t p;
+        do {
+            p = uniformBelow(source, static_cast<uint32_t>(length));
+        } while (std::find(positions, positions + i, p) != positions + i);
+        positions[i] = p;
+    }
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_INDEX_SAMPLER_H
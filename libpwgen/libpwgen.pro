@@ -0,0 +1,26 @@
+TEMPLATE = lib
+TARGET = pwgen
+
+# Plain C++ library, no Qt modules
+CONFIG -= qt
+CONFIG += c++11 hide_symbols
+
+# Shared by default; build with `qmake CONFIG+=staticlib` for libpwgen.a
+!staticlib: DEFINES += PWGEN_SHARED
+
+SOURCES += pwgen.cpp
+HEADERS += pwgen.h \
+           secure_random.h \
+           index_sampler.h \
+           charset_kernel.h \
+           charset_policy.h \
+           strength.h \
+           dictionary.h \
+           estimator.h \
+           password_pool.h \
+           secure_memory.h \
+           wordlist.h \
+           sha1.h \
+           breach.h \
+           unique_filter.h \
+           site_policy.h
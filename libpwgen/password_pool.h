@@ -0,0 +1,236 @@
+#ifndef PWGEN_PASSWORD_POOL_H
+#define PWGEN_PASSWORD_POOL_H
+
+// Ring buffer of ready-made passwords for one policy, kept topped up by a
+// background thread, so taking a password is a copy rather than a generation.
+//
+// The ring is one block of the secure arena (secure_memory.h) and must be
+// locked there: if it can't be, the pool stays disabled and take() always
+// returns false, so callers keep generating on demand. Every slot is wiped as
+// it is handed out, the whole ring when the policy changes, and the block
+// again when it goes back to the arena. Given a breached-password corpus,
+// the refill thread redraws any password found in it before it is pooled.
+//
+//   pwgen::PasswordPool pool;
+//   if (!pool.take(options, length, out)) {
+//       pwgen_generate(ctx, out, length);   // first call, new policy, or drained
+//   }
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "breach.h"
+#include "pwgen.h"
+#include "secure_memory.h"
+#include "secure_random.h"
+
+namespace pwgen {
+
+class PasswordPool {
+public:
+    static const size_t DEFAULT_CAPACITY = 64;       // passwords
+    static const size_t DEFAULT_BYTES = 64 * 1024;   // locked memory
+
+    explicit PasswordPool(size_t capacity = DEFAULT_CAPACITY, size_t bytes = DEFAULT_BYTES,
+                          const BreachCorpus* corpus = nullptr)
+        : maxSlots(capacity), breachCorpus(corpus && !corpus->empty() ? corpus : nullptr) {
+        pwgen_options_init(&policy);
+        allocate(bytes);
+        if (base) {
+            worker = std::thread(&PasswordPool::refillLoop, this);
+        }
+    }
+
+    ~PasswordPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        release();
+    }
+
+    // Copy one pooled password of `length` characters for `options` into
+    // `out`. Returns false if none is ready: the pool is disabled, still
+    // filling, or was just switched to this policy (it refills in the
+    // background for next time).
+    bool take(const pwgen_options& options, size_t length, char* out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!base) return false;
+        if (!active || length != slotLength || !samePolicy(options, policy)) {
+            switchPolicy(options, length);
+            return false;
+        }
+        if (filled == 0) return false;
+
+        char* slot = slotAt(head);
+        memcpy(out, slot, slotLength);
+        secureZero(slot, slotLength);
+        head = (head + 1) % slots;
+        filled--;
+        if (filled <= slots / 2) {
+            wake.notify_one();
+        }
+        return true;
+    }
+
+    // Drop every pooled password and stop refilling until the next take()
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        discard();
+        active = false;
+    }
+
+    size_t available() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return filled;
+    }
+
+    // False if locked memory wasn't available and the pool is disabled
+    bool enabled() const { return base != nullptr; }
+
+private:
+    const size_t maxSlots;
+    const BreachCorpus* const breachCorpus;   // null = no screening
+    char* base = nullptr;
+    size_t regionSize = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stopping = false;
+
+    // Guarded by mutex
+    pwgen_options policy;
+    bool active = false;
+    unsigned long long epoch = 0;   // bumped on every policy switch
+    size_t slotLength = 0;
+    size_t slots = 0;
+    size_t head = 0;                // oldest ready password
+    size_t filled = 0;
+
+    PasswordPool(const PasswordPool&);
+    PasswordPool& operator=(const PasswordPool&);
+
+    static bool samePolicy(const pwgen_options& a, const pwgen_options& b) {
+        return a.use_upper == b.use_upper && a.use_lower == b.use_lower &&
+               a.use_digits == b.use_digits && a.use_special == b.use_special &&
+               a.enforce_minimum == b.enforce_minimum && a.avoid_similar == b.avoid_similar &&
+               a.rng == b.rng && a.seed == b.seed;
+    }
+
+    char* slotAt(size_t index) const { return base + index * slotLength; }
+
+    void allocate(size_t bytes) {
+        bool locked = false;
+        char* region = static_cast<char*>(secureArena().allocate(bytes, &locked));
+        if (!locked) {
+            secureArena().deallocate(region, bytes);
+            return;
+        }
+        base = region;
+        regionSize = bytes;
+    }
+
+    void release() {
+        if (!base) return;
+        secureArena().deallocate(base, regionSize);
+        base = nullptr;
+    }
+
+    // Wipe the ready passwords. A batch being generated lies outside them
+    // and is wiped by the worker when it sees the epoch change.
+    void discard() {
+        for (size_t i = 0; i < filled; i++) {
+            secureZero(slotAt((head + i) % slots), slotLength);
+        }
+        head = 0;
+        filled = 0;
+        epoch++;
+    }
+
+    void switchPolicy(const pwgen_options& options, size_t length) {
+        discard();
+        policy = options;
+        slotLength = length;
+        slots = length ? (std::min)(maxSlots, regionSize / length) : 0;
+        active = slots > 0;
+        wake.notify_one();
+    }
+
+    // Background thread: whenever the ring is half empty, fill every free
+    // slot in one pass. The context is private to this thread.
+    void refillLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        pwgen_ctx* context = nullptr;
+        unsigned long long contextEpoch = 0;
+
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || (active && filled <= slots / 2); });
+            if (stopping) break;
+
+            unsigned long long batchEpoch = epoch;
+            pwgen_options batchPolicy = policy;
+            size_t length = slotLength;
+            size_t first = (head + filled) % slots;
+            size_t count = slots - filled;
+            size_t ringSlots = slots;
+
+            // The free slots belong to this thread until `filled` covers them
+            lock.unlock();
+            if (!context || contextEpoch != batchEpoch) {
+                pwgen_free(context);
+                context = pwgen_ctx_new(&batchPolicy);
+                contextEpoch = batchEpoch;
+            }
+            size_t tail = (std::min)(count, ringSlots - first);
+            int rc = context ? PWGEN_OK : PWGEN_ENOMEM;
+            if (rc == PWGEN_OK) {
+                rc = pwgen_generate_batch(context, base + first * length, tail, length, 0);
+            }
+            if (rc == PWGEN_OK && count > tail) {
+                rc = pwgen_generate_batch(context, base, count - tail, length, 0);
+            }
+            for (size_t i = 0; rc == PWGEN_OK && i < count; i++) {
+                rc = screen(context, base + ((first + i) % ringSlots) * length, length);
+            }
+            lock.lock();
+
+            if (batchEpoch != epoch || rc != PWGEN_OK) {
+                // Policy changed meanwhile, or it can't be generated (e.g.
+                // too short for its required classes): throw the batch away
+                secureZero(base + first * length, tail * length);
+                secureZero(base, (count - tail) * length);
+                if (batchEpoch == epoch) active = false;
+                continue;
+            }
+            filled += count;
+        }
+
+        lock.unlock();
+        pwgen_free(context);
+    }
+
+    // Redraw a freshly generated password while it is in the breach corpus;
+    // PWGEN_EINVAL if the policy keeps producing breached ones
+    int screen(pwgen_ctx* context, char* slot, size_t length) const {
+        if (!breachCorpus) return PWGEN_OK;
+        for (int attempt = 1; breachCorpus->contains(slot, length); attempt++) {
+            if (attempt >= BREACH_MAX_RETRIES) return PWGEN_EINVAL;
+            int rc = pwgen_generate(context, slot, length);
+            if (rc != PWGEN_OK) return rc;
+        }
+        return PWGEN_OK;
+    }
+};
+
+} // namespace pwgen
+
+#endif // PWGEN_PASSWORD_POOL_H
@@ -0,0 +1,177 @@
+// C interface over the libpwgen C++ core (see pwgen.h).
+// Exceptions never cross the ABI boundary; they become PWGEN_* codes.
+
+#define PWGEN_BUILDING
+#include "pwgen.h"
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+#include "charset_policy.h"
+#include "estimator.h"
+#include "secure_random.h"
+#include "strength.h"
+
+struct pwgen_ctx {
+    std::unique_ptr<pwgen::CharsetPolicy> policy;
+    std::unique_ptr<pwgen::RandomSource> random;
+    pwgen::SeededRandom* seeded = nullptr; // `random`, if PWGEN_RNG_SEEDED
+};
+
+namespace {
+
+// Copy only the fields the caller's struct version actually has. False if
+// struct_size can't be a real version (0 or smaller than the field itself),
+// which means the struct never went through pwgen_options_init().
+bool readOptions(const pwgen_options* options, pwgen_options& result) {
+    pwgen_options_init(&result);
+    if (!options) return true;
+
+    size_t size = options->struct_size;
+    if (size < sizeof(options->struct_size)) return false;
+    if (size > sizeof(result)) size = sizeof(result);
+    memcpy(&result, options, size);
+    result.struct_size = sizeof(result);
+    return true;
+}
+
+bool toBackend(int rng, pwgen::RandomBackend& backend) {
+    switch (rng) {
+        case PWGEN_RNG_CHACHA20: backend = pwgen::RandomBackend::ChaCha20; return true;
+        case PWGEN_RNG_SYSTEM: backend = pwgen::RandomBackend::System; return true;
+        case PWGEN_RNG_MT19937: backend = pwgen::RandomBackend::Mt19937; return true;
+        case PWGEN_RNG_SEEDED: backend = pwgen::RandomBackend::Seeded; return true;
+    }
+    return false;
+}
+
+} // namespace
+
+extern "C" {
+
+int pwgen_abi_version(void) {
+    return PWGEN_ABI_VERSION;
+}
+
+void pwgen_options_init(pwgen_options* options) {
+    if (!options) return;
+    options->struct_size = sizeof(*options);
+    options->use_upper = 1;
+    options->use_lower = 1;
+    options->use_digits = 1;
+    options->use_special = 1;
+    options->enforce_minimum = 1;
+    options->avoid_similar = 0;
+    options->rng = PWGEN_RNG_CHACHA20;
+    options->seed = 0;
+}
+
+pwgen_ctx* pwgen_ctx_new(const pwgen_options* options) {
+    pwgen_options opts;
+    if (!readOptions(options, opts)) return nullptr;
+
+    pwgen::RandomBackend backend;
+    if (!toBackend(opts.rng, backend)) return nullptr;
+
+    pwgen::CharsetOptions charset;
+    charset.useUpper = opts.use_upper != 0;
+    charset.useLower = opts.use_lower != 0;
+    charset.useDigits = opts.use_digits != 0;
+    charset.useSpecial = opts.use_special != 0;
+    charset.enforceMinimum = opts.enforce_minimum != 0;
+    charset.avoidSimilar = opts.avoid_similar != 0;
+
+    try {
+        std::unique_ptr<pwgen_ctx> ctx(new pwgen_ctx());
+        ctx->policy.reset(new pwgen::CharsetPolicy(charset));
+        ctx->random = pwgen::makeRandomSource(backend, opts.seed);
+        if (backend == pwgen::RandomBackend::Seeded) {
+            ctx->seeded = static_cast<pwgen::SeededRandom*>(ctx->random.get());
+        }
+        return ctx.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+size_t pwgen_min_length(const pwgen_ctx* ctx) {
+    return ctx ? ctx->policy->minimumLength() : 0;
+}
+
+int pwgen_generate(pwgen_ctx* ctx, char* out, size_t length) {
+    return pwgen_generate_batch(ctx, out, 1, length, length);
+}
+
+int pwgen_generate_batch(pwgen_ctx* ctx, char* arena, size_t count, size_t length, size_t stride) {
+    if (!ctx || (!arena && count > 0)) return PWGEN_EINVAL;
+    if (count > 0 && length < ctx->policy->minimumLength()) return PWGEN_EINVAL;
+    if (stride == 0) stride = length;
+    if (stride < length) return PWGEN_EINVAL;
+
+    try {
+        if (ctx->seeded) {
+            // One keystream per password, so each depends only on its index
+            for (size_t i = 0; i < count; i++) {
+                ctx->seeded->beginPassword();
+                ctx->policy->generateInto(*ctx->random, arena + i * stride, length);
+            }
+            return PWGEN_OK;
+        }
+        ctx->policy->generateBatch(*ctx->random, arena, count, length, stride);
+        return PWGEN_OK;
+    } catch (const std::bad_alloc&) {
+        return PWGEN_ENOMEM;
+    } catch (const std::runtime_error&) {
+        return PWGEN_ERANDOM;
+    } catch (...) {
+        return PWGEN_EINVAL;
+    }
+}
+
+double pwgen_entropy_bits(const pwgen_ctx* ctx, size_t length) {
+    return ctx ? ctx->policy->entropyBits(length) : 0.0;
+}
+
+int pwgen_expected_strength(const pwgen_ctx* ctx, size_t length) {
+    return ctx ? ctx->policy->expectedStrength(length) : -1;
+}
+
+int pwgen_strength(const char* password, size_t length) {
+    return password ? pwgen::calculateStrength(password, length) : 0;
+}
+
+int pwgen_estimate(const char* password, size_t length, double* guesses_log10) {
+    if (!password) length = 0;
+    try {
+        pwgen::Estimate estimate = pwgen::estimateStrength(password ? password : "", length);
+        if (guesses_log10) *guesses_log10 = estimate.guessesLog10;
+        return estimate.score;
+    } catch (...) {
+        if (guesses_log10) *guesses_log10 = 0;
+        return 0;
+    }
+}
+
+int pwgen_seek(pwgen_ctx* ctx, unsigned long long index, unsigned int retry) {
+    if (!ctx || !ctx->seeded) return PWGEN_EINVAL;
+    ctx->seeded->seek(index, retry);
+    return PWGEN_OK;
+}
+
+void pwgen_free(pwgen_ctx* ctx) {
+    delete ctx;
+}
+
+const char* pwgen_strerror(int code) {
+    switch (code) {
+        case PWGEN_OK: return "success";
+        case PWGEN_EINVAL: return "invalid argument";
+        case PWGEN_ENOMEM: return "out of memory";
+        case PWGEN_ERANDOM: return "random source failure";
+    }
+    return "unknown error";
+}
+
+} // extern "C"
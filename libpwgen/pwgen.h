@@ -0,0 +1,127 @@
+#ifndef PWGEN_H
+#define PWGEN_H
+
+/*
+ * libpwgen - stable C interface to the password generator core.
+ *
+ * A context holds one compiled character-set policy and its own random
+ * source. Contexts are not thread-safe; create one per thread. No call
+ * allocates per password, and generated bytes are never NUL-terminated.
+ */
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(PWGEN_SHARED)
+#  if defined(PWGEN_BUILDING)
+#    define PWGEN_API __declspec(dllexport)
+#  else
+#    define PWGEN_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define PWGEN_API __attribute__((visibility("default")))
+#else
+#  define PWGEN_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PWGEN_ABI_VERSION 1
+
+/* Return codes */
+#define PWGEN_OK 0
+#define PWGEN_EINVAL (-1)  /* bad argument, e.g. length below pwgen_min_length() */
+#define PWGEN_ENOMEM (-2)  /* allocation failed */
+#define PWGEN_ERANDOM (-3) /* the random source failed */
+
+/* Random backends */
+#define PWGEN_RNG_CHACHA20 0 /* default */
+#define PWGEN_RNG_SYSTEM 1   /* getrandom() / arc4random_buf() */
+#define PWGEN_RNG_MT19937 2  /* NOT cryptographically secure, comparison only */
+#define PWGEN_RNG_SEEDED 3   /* reproducible from `seed`, for tests only: NEVER for real credentials */
+
+typedef struct pwgen_ctx pwgen_ctx;
+
+typedef struct pwgen_options {
+    size_t struct_size; /* sizeof(pwgen_options), set by pwgen_options_init() */
+    int use_upper;
+    int use_lower;
+    int use_digits;
+    int use_special;
+    int enforce_minimum; /* at least one character of each enabled class */
+    int avoid_similar;   /* drop I, l, 1, O, 0 */
+    int rng;             /* PWGEN_RNG_* */
+    unsigned long long seed; /* key of PWGEN_RNG_SEEDED, ignored otherwise */
+} pwgen_options;
+
+/* Version of the ABI this library was built with */
+PWGEN_API int pwgen_abi_version(void);
+
+/* Fill `options` with the defaults (all classes, enforce minimum, ChaCha20) */
+PWGEN_API void pwgen_options_init(pwgen_options* options);
+
+/*
+ * Create a context; NULL options means defaults. Returns NULL on failure,
+ * including options whose struct_size is 0 (not set by pwgen_options_init()).
+ */
+PWGEN_API pwgen_ctx* pwgen_ctx_new(const pwgen_options* options);
+
+/* Shortest password length the context's policy can satisfy */
+PWGEN_API size_t pwgen_min_length(const pwgen_ctx* ctx);
+
+/* Write one password of `length` characters to `out` */
+PWGEN_API int pwgen_generate(pwgen_ctx* ctx, char* out, size_t length);
+
+/*
+ * Write `count` passwords of `length` characters into `arena`, one every
+ * `stride` bytes (stride >= length, or 0 for length). Bytes between
+ * passwords are left untouched, so delimiters can be pre-filled.
+ */
+PWGEN_API int pwgen_generate_batch(pwgen_ctx* ctx, char* arena, size_t count,
+                                   size_t length, size_t stride);
+
+/*
+ * Shannon entropy in bits of a `length`-character password from the context.
+ * With enforce_minimum this is the exact entropy of the constrained draw,
+ * slightly below log2 of the number of valid passwords. Needs no generation.
+ */
+PWGEN_API double pwgen_entropy_bits(const pwgen_ctx* ctx, size_t length);
+
+/*
+ * Strength score (0-100) that every `length`-character password from the
+ * context will get, or -1 if it depends on the characters drawn.
+ */
+PWGEN_API int pwgen_expected_strength(const pwgen_ctx* ctx, size_t length);
+
+/* Strength score (0-100) of an arbitrary password, in one table-driven pass */
+PWGEN_API int pwgen_strength(const char* password, size_t length);
+
+/*
+ * Pattern-matching (zxcvbn-style) strength score (0-100) of an arbitrary
+ * password: dictionary words, keyboard walks, repeats, sequences and dates
+ * count as the guesses they cost an attacker. Stores log10 of the estimated
+ * guesses in `guesses_log10` if it is not NULL.
+ */
+PWGEN_API int pwgen_estimate(const char* password, size_t length, double* guesses_log10);
+
+/*
+ * PWGEN_RNG_SEEDED only: make the next password generated the `index`-th of
+ * the seed's stream (0-based); each password generated advances by one.
+ * Password `index` is the same whichever context or thread computes it.
+ * `retry` > 0 gives an independent alternative for that index, for callers
+ * that reject a password and draw it again. PWGEN_EINVAL for other contexts.
+ */
+PWGEN_API int pwgen_seek(pwgen_ctx* ctx, unsigned long long index, unsigned int retry);
+
+/* Destroy a context and wipe its state; NULL is ignored */
+PWGEN_API void pwgen_free(pwgen_ctx* ctx);
+
+/* Static description of a PWGEN_* return code */
+PWGEN_API const char* pwgen_strerror(int code);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWGEN_H */
@@ -0,0 +1,266 @@
+#ifndef PWGEN_SECURE_MEMORY_H
+#define PWGEN_SECURE_MEMORY_H
+
+// Process-wide arena for password storage.
+//
+// Memory comes from a few large mappings instead of the general heap. They
+// are pinned with mlock()/VirtualLock() so secrets never reach swap, and
+// excluded from core dumps (MADV_DONTDUMP). Every block is wiped with
+// secureZero() when it is freed, so there are no stale copies for
+// reallocation or a later heap user to find.
+//
+//   Small blocks (<= 4 KiB) are carved from 64 KiB chunks into power-of-two
+//   size classes and recycled through per-class free lists.
+//   Large blocks get their own page-rounded mapping. A freed one is kept
+//   (wiped) for the next request of the same size, so bulk mode's
+//   fixed-size output chunks map and lock their memory once.
+//
+// If the lock limit (RLIMIT_MEMLOCK) is reached, mappings are still used,
+// unlocked but still excluded from dumps and still wiped. allocate() reports
+// whether a block is locked for callers that insist on it.
+//
+//   pwgen::SecureBytes password(length);     // std::vector in the arena
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "secure_random.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace pwgen {
+
+class SecureArena {
+public:
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t MIN_BLOCK = 16;
+    static const size_t MAX_SMALL = 4096;
+    static const size_t LARGE_CACHE = 64 << 20;   // bytes of freed large blocks kept
+
+    SecureArena() : pageSize(systemPageSize()) {
+        for (size_t i = 0; i < CLASS_COUNT; i++) {
+            freeLists[i] = nullptr;
+        }
+    }
+
+    // Allocate `size` bytes (zeroed on first use, wiped on every free);
+    // `locked`, if given, says whether the block is pinned in RAM
+    void* allocate(size_t size, bool* locked = nullptr) {
+        if (size == 0) size = 1;
+        std::lock_guard<std::mutex> lock(mutex);
+        return size <= MAX_SMALL ? allocateSmall(size, locked) : allocateLarge(size, locked);
+    }
+
+    // Wipe and free a block; `size` must be the size it was allocated with
+    void deallocate(void* block, size_t size) {
+        if (!block) return;
+        if (size == 0) size = 1;
+        secureZero(block, size);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size <= MAX_SMALL) {
+            FreeBlock* freed = static_cast<FreeBlock*>(block);
+            size_t index = classIndex(size);
+            freed->next = freeLists[index];
+            freeLists[index] = freed;
+        } else {
+            freeLarge(block);
+        }
+    }
+
+private:
+    static const size_t CLASS_COUNT = 9;   // 16, 32, ..., 4096
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Mapping {
+        size_t size;
+        bool locked;
+    };
+
+    const size_t pageSize;
+    std::mutex mutex;
+    FreeBlock* freeLists[CLASS_COUNT];
+    char* chunk = nullptr;            // current small-block chunk
+    size_t chunkUsed = CHUNK_SIZE;
+    bool chunkLocked = false;
+    std::map<void*, Mapping> large;                 // live large blocks
+    std::multimap<size_t, std::pair<void*, bool>> cached;   // freed, by mapped size
+    size_t cachedBytes = 0;
+
+    SecureArena(const SecureArena&);
+    SecureArena& operator=(const SecureArena&);
+
+    static size_t systemPageSize() {
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+#elif defined(__unix__) || defined(__APPLE__)
+        long size = sysconf(_SC_PAGESIZE);
+        return size > 0 ? static_cast<size_t>(size) : 4096;
+#else
+        return 4096;
+#endif
+    }
+
+    static size_t classIndex(size_t size) {
+        size_t index = 0;
+        size_t block = MIN_BLOCK;
+        while (block < size) {
+            block <<= 1;
+            index++;
+        }
+        return index;
+    }
+
+    // Map, lock and dump-exclude `size` (page-rounded) bytes
+    static void* mapRegion(size_t size, bool& locked) {
+        locked = false;
+#if defined(_WIN32)
+        void* region = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!region) return nullptr;
+        locked = VirtualLock(region, size) != 0;
+        return region;
+#elif defined(__unix__) || defined(__APPLE__)
+        void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED) return nullptr;
+#if defined(MADV_DONTDUMP)
+        madvise(region, size, MADV_DONTDUMP);
+#elif defined(MADV_NOCORE)
+        madvise(region, size, MADV_NOCORE);
+#endif
+        locked = mlock(region, size) == 0;
+        return region;
+#else
+        return calloc(1, size);
+#endif
+    }
+
+    static void unmapRegion(void* region, size_t size, bool locked) {
+#if defined(_WIN32)
+        if (locked) VirtualUnlock(region, size);
+        VirtualFree(region, 0, MEM_RELEASE);
+#elif defined(__unix__) || defined(__APPLE__)
+        if (locked) munlock(region, size);
+        munmap(region, size);
+#else
+        (void)size;
+        (void)locked;
+        free(region);
+#endif
+    }
+
+    void* allocateSmall(size_t size, bool* locked) {
+        size_t index = classIndex(size);
+        size_t blockSize = MIN_BLOCK << index;
+        void* block;
+        if (freeLists[index]) {
+            FreeBlock* freed = freeLists[index];
+            freeLists[index] = freed->next;
+            freed->next = nullptr;
+            block = freed;
+        } else {
+            if (chunkUsed + blockSize > CHUNK_SIZE) {
+                // The tail of the old chunk is abandoned; chunks are never
+                // returned, like the heap they replace
+                chunk = static_cast<char*>(mapRegion(CHUNK_SIZE, chunkLocked));
+                if (!chunk) throw std::bad_alloc();
+                chunkUsed = 0;
+            }
+            block = chunk + chunkUsed;
+            chunkUsed += blockSize;
+        }
+        // Lock state is only tracked per chunk; a recycled block reports the
+        // current chunk's, which is exact whenever the lock limit isn't hit
+        if (locked) *locked = chunkLocked;
+        return block;
+    }
+
+    void* allocateLarge(size_t size, bool* locked) {
+        size_t mapped = (size + pageSize - 1) / pageSize * pageSize;
+        void* block;
+        bool isLocked;
+        auto reuse = cached.find(mapped);
+        if (reuse != cached.end()) {
+            block = reuse->second.first;
+            isLocked = reuse->second.second;
+            cached.erase(reuse);
+            cachedBytes -= mapped;
+        } else {
+            block = mapRegion(mapped, isLocked);
+            if (!block) throw std::bad_alloc();
+        }
+        Mapping mapping = { mapped, isLocked };
+        large[block] = mapping;
+        if (locked) *locked = isLocked;
+        return block;
+    }
+
+    void freeLarge(void* block) {
+        auto it = large.find(block);
+        if (it == large.end()) return;
+        Mapping mapping = it->second;
+        large.erase(it);
+        if (cachedBytes + mapping.size <= LARGE_CACHE) {
+            cached.insert(std::make_pair(mapping.size, std::make_pair(block, mapping.locked)));
+            cachedBytes += mapping.size;
+        } else {
+            unmapRegion(block, mapping.size, mapping.locked);
+        }
+    }
+};
+
+// The arena lives for the whole process (never destroyed, so blocks freed
+// during static destruction are still wiped correctly)
+inline SecureArena& secureArena() {
+    static SecureArena* arena = new SecureArena();
+    return *arena;
+}
+
+// Standard allocator over the arena, for containers holding secrets
+template <typename T>
+struct SecureAllocator {
+    typedef T value_type;
+
+    SecureAllocator() {}
+    template <typename U>
+    SecureAllocator(const SecureAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(secureArena().allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        secureArena().deallocate(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const SecureAllocator<T>&, const SecureAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const SecureAllocator<T>&, const SecureAllocator<U>&) { return false; }
+
+// Byte buffer in the arena. Deliberately a vector rather than a string: a
+// std::string keeps short contents inline, outside the allocator's reach.
+typedef std::vector<char, SecureAllocator<char>> SecureBytes;
+
+} // namespace pwgen
+
+#endif // PWGEN_SECURE_MEMORY_H
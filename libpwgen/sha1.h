@@ -0,0 +1,140 @@
+#ifndef PWGEN_SHA1_H
+#define PWGEN_SHA1_H
+
+// SHA-1 (FIPS 180-4), only as the lookup key of the breached-password corpus
+// (breach.h), which is distributed as SHA-1 hashes. Not used for anything
+// that relies on collision resistance.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "secure_random.h"
+
+namespace pwgen {
+
+const size_t SHA1_DIGEST_SIZE = 20;
+
+class Sha1 {
+public:
+    Sha1() { reset(); }
+
+    void reset() {
+        state[0] = 0x67452301;
+        state[1] = 0xEFCDAB89;
+        state[2] = 0x98BADCFE;
+        state[3] = 0x10325476;
+        state[4] = 0xC3D2E1F0;
+        total = 0;
+        used = 0;
+    }
+
+    void update(const void* data, size_t length) {
+        const unsigned char* in = static_cast<const unsigned char*>(data);
+        total += length;
+        if (used > 0) {
+            size_t take = length < 64 - used ? length : 64 - used;
+            memcpy(block + used, in, take);
+            used += take;
+            in += take;
+            length -= take;
+            if (used < 64) return;
+            compress(block);
+            used = 0;
+        }
+        for (; length >= 64; in += 64, length -= 64) {
+            compress(in);
+        }
+        memcpy(block, in, length);
+        used = length;
+    }
+
+    // Write the digest and wipe the state (block, schedule and all); reset()
+    // before reusing
+    void final(unsigned char digest[SHA1_DIGEST_SIZE]) {
+        uint64_t bits = total * 8;
+        block[used++] = 0x80;
+        if (used > 56) {
+            memset(block + used, 0, 64 - used);
+            compress(block);
+            used = 0;
+        }
+        memset(block + used, 0, 56 - used);
+        for (int i = 0; i < 8; i++) {
+            block[56 + i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+        }
+        compress(block);
+        for (int i = 0; i < 5; i++) {
+            digest[4 * i] = static_cast<unsigned char>(state[i] >> 24);
+            digest[4 * i + 1] = static_cast<unsigned char>(state[i] >> 16);
+            digest[4 * i + 2] = static_cast<unsigned char>(state[i] >> 8);
+            digest[4 * i + 3] = static_cast<unsigned char>(state[i]);
+        }
+        secureZero(this, sizeof(*this));
+    }
+
+private:
+    uint32_t state[5];
+    uint64_t total;
+    size_t used;
+    unsigned char block[64];
+    uint32_t schedule[16];   // message schedule, kept as a 16-word ring
+
+    static uint32_t rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+    // Word i of the message schedule, computed in place from the ring
+    uint32_t word(int i) {
+        uint32_t* w = schedule;
+        if (i >= 16) {
+            w[i & 15] = rotl(w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15], 1);
+        }
+        return w[i & 15];
+    }
+
+    // One step; `mixed` is f(b, c, d) + K + W[i]
+    static void round(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d, uint32_t& e, uint32_t mixed) {
+        uint32_t t = rotl(a, 5) + e + mixed;
+        e = d;
+        d = c;
+        c = rotl(b, 30);
+        b = a;
+        a = t;
+    }
+
+    void compress(const unsigned char* in) {
+        uint32_t* w = schedule;
+        for (int i = 0; i < 16; i++) {
+            w[i] = uint32_t(in[4 * i]) << 24 | uint32_t(in[4 * i + 1]) << 16 |
+                   uint32_t(in[4 * i + 2]) << 8 | uint32_t(in[4 * i + 3]);
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 20; i++) {
+            round(a, b, c, d, e, ((b & c) | (~b & d)) + 0x5A827999 + word(i));
+        }
+        for (int i = 20; i < 40; i++) {
+            round(a, b, c, d, e, (b ^ c ^ d) + 0x6ED9EBA1 + word(i));
+        }
+        for (int i = 40; i < 60; i++) {
+            round(a, b, c, d, e, ((b & c) | (b & d) | (c & d)) + 0x8F1BBCDC + word(i));
+        }
+        for (int i = 60; i < 80; i++) {
+            round(a, b, c, d, e, (b ^ c ^ d) + 0xCA62C1D6 + word(i));
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+};
+
+inline void sha1(const void* data, size_t length, unsigned char digest[SHA1_DIGEST_SIZE]) {
+    Sha1 hash;
+    hash.update(data, length);
+    hash.final(digest);
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_SHA1_H
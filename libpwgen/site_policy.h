@@ -0,0 +1,667 @@
+#ifndef PWGEN_SITE_POLICY_H
+#define PWGEN_SITE_POLICY_H
+
+// Site password policies ("2-4 digits, no more than 2 identical characters in
+// a row, no <>&, must start with a letter"), compiled into a counting
+// automaton that samples uniformly over every valid password in one pass.
+//
+// A password is written left to right. Its state after each character is the
+// number of characters of each class so far, capped where the rules stop
+// caring, plus the class and run length of the last character when runs are
+// limited. The compiler counts, in arbitrary precision, the valid completions
+// ways[p][s] from every state s after p characters. Generation then picks
+// each next character with probability proportional to the completions it
+// leaves. That is an exactly uniform draw over all valid passwords, and
+// nothing is generated and thrown away, however tight the rules.
+//
+// Rules are "key = value" settings, the same in policy files and on the
+// command line:
+//
+//   upper = 1-        at least one uppercase letter
+//   digits = 2-4      two to four digits
+//   special = 0       no special characters
+//   exclude = <>&     never use these characters
+//   max-repeat = 2    at most two identical characters in a row
+//   start = letter    first character: upper, lower, letter, digit, special
+//   length = 12       password length (the caller's default otherwise)
+//
+// Classes a policy doesn't mention keep the front end's settings.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "charset_policy.h"
+#include "index_sampler.h"
+#include "secure_random.h"
+
+namespace pwgen {
+
+const int POLICY_MAX_LENGTH = 1024;
+
+// Limit on compiled states times positions, which bounds compile time and
+// memory; only many large per-class maximums together get near it
+const size_t POLICY_MAX_TABLE = 1 << 18;
+
+struct ClassRule {
+    int min = 0;
+    int max = -1;   // -1 = no limit
+};
+
+struct PolicyRules {
+    ClassRule classes[4];      // by CharClass
+    std::string exclude;
+    int maxRepeat = 0;         // longest run of one character, 0 = no limit
+    uint8_t startClasses = 0;  // CLASS_* bits allowed first, 0 = any
+    int length = 0;            // 0 = the caller's length
+};
+
+// Ordered "key = value" settings, as read from a policy file
+typedef std::vector<std::pair<std::string, std::string>> PolicySettings;
+
+// The rules equivalent to the plain charset options: enabled classes
+// unlimited (at least one each with enforceMinimum), disabled ones absent
+inline PolicyRules policyRulesFrom(const CharsetOptions& options) {
+    bool used[4] = { options.useUpper, options.useLower, options.useDigits, options.useSpecial };
+    if (!used[0] && !used[1] && !used[2] && !used[3]) {
+        used[static_cast<int>(CharClass::Lower)] = true;
+    }
+    PolicyRules rules;
+    for (int c = 0; c < 4; c++) {
+        rules.classes[c].min = used[c] && options.enforceMinimum ? 1 : 0;
+        rules.classes[c].max = used[c] ? -1 : 0;
+    }
+    if (options.avoidSimilar) {
+        rules.exclude = SIMILAR;
+    }
+    return rules;
+}
+
+namespace detail {
+
+inline bool parsePolicyNumber(const std::string& text, int& value) {
+    if (text.empty() || text.size() > 4) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    value = atoi(text.c_str());
+    return true;
+}
+
+// "3", "2-4", "1-" (no upper limit) or "-2" (zero to two)
+inline bool parseClassRange(const std::string& text, ClassRule& rule) {
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) {
+        if (!parsePolicyNumber(text, rule.min)) return false;
+        rule.max = rule.min;
+        return true;
+    }
+    std::string low = text.substr(0, dash);
+    std::string high = text.substr(dash + 1);
+    rule.min = 0;
+    rule.max = -1;
+    if (!low.empty() && !parsePolicyNumber(low, rule.min)) return false;
+    if (!high.empty() && !parsePolicyNumber(high, rule.max)) return false;
+    return !(low.empty() && high.empty()) && (rule.max < 0 || rule.min <= rule.max);
+}
+
+// "letter", "upper,digit", ... or "any" (0)
+inline bool parseStartClasses(const std::string& text, uint8_t& classes) {
+    classes = 0;
+    if (text == "any") return true;
+    for (size_t start = 0; start <= text.size();) {
+        size_t end = text.find_first_of(",| ", start);
+        if (end == std::string::npos) end = text.size();
+        std::string name = text.substr(start, end - start);
+        if (name == "upper") classes |= CLASS_UPPER;
+        else if (name == "lower") classes |= CLASS_LOWER;
+        else if (name == "letter") classes |= CLASS_UPPER | CLASS_LOWER;
+        else if (name == "digit" || name == "digits") classes |= CLASS_DIGIT;
+        else if (name == "special") classes |= CLASS_SPECIAL;
+        else if (!name.empty()) return false;
+        start = end + 1;
+    }
+    return classes != 0;
+}
+
+inline std::string trimPolicyText(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) return std::string();
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+} // namespace detail
+
+// Apply one setting to `rules`; false with a message in `error` if the key
+// is unknown or the value malformed
+inline bool applyPolicySetting(PolicyRules& rules, const std::string& key, const std::string& value,
+                               std::string& error) {
+    static const char* const classKeys[4] = { "upper", "lower", "digits", "special" };
+    for (int c = 0; c < 4; c++) {
+        if (key == classKeys[c]) {
+            if (!detail::parseClassRange(value, rules.classes[c])) {
+                error = key + ": expected a count or a range like 2-4, 1- or -3";
+                return false;
+            }
+            return true;
+        }
+    }
+    if (key == "exclude") {
+        rules.exclude += value;
+    } else if (key == "max-repeat") {
+        if (!detail::parsePolicyNumber(value, rules.maxRepeat)) {
+            error = "max-repeat: expected a number (0 for no limit)";
+            return false;
+        }
+    } else if (key == "start") {
+        if (!detail::parseStartClasses(value, rules.startClasses)) {
+            error = "start: expected upper, lower, letter, digit, special or any";
+            return false;
+        }
+    } else if (key == "length") {
+        if (!detail::parsePolicyNumber(value, rules.length) || rules.length < 1 ||
+            rules.length > POLICY_MAX_LENGTH) {
+            error = "length: expected a number from 1 to " + std::to_string(POLICY_MAX_LENGTH);
+            return false;
+        }
+    } else {
+        error = "unknown setting '" + key + "'";
+        return false;
+    }
+    return true;
+}
+
+inline bool applyPolicySettings(PolicyRules& rules, const PolicySettings& settings, std::string& error) {
+    for (const auto& setting : settings) {
+        if (!applyPolicySetting(rules, setting.first, setting.second, error)) return false;
+    }
+    return true;
+}
+
+// Read a policy file: one "key = value" per line, '#' starts a comment line.
+// Every setting is checked, so errors name their line.
+inline bool readPolicyFile(const std::string& path, PolicySettings& settings, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot read " + path;
+        return false;
+    }
+    PolicySettings read;
+    PolicyRules scratch;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::string text = detail::trimPolicyText(line);
+        if (text.empty() || text[0] == '#') continue;
+        size_t equals = text.find('=');
+        std::string key = detail::trimPolicyText(text.substr(0, equals));
+        std::string value = equals == std::string::npos ? std::string() : detail::trimPolicyText(text.substr(equals + 1));
+        std::string problem;
+        if (equals == std::string::npos) {
+            problem = "expected key = value";
+        } else {
+            applyPolicySetting(scratch, key, value, problem);
+        }
+        if (!problem.empty()) {
+            error = path + ":" + std::to_string(lineNumber) + ": " + problem;
+            return false;
+        }
+        read.push_back(std::make_pair(key, value));
+    }
+    settings.insert(settings.end(), read.begin(), read.end());
+    return true;
+}
+
+// Unsigned integer of any size, just enough to count passwords exactly
+class BigCount {
+public:
+    BigCount() {}
+
+    explicit BigCount(uint64_t value) {
+        if (value) limbs.push_back(static_cast<uint32_t>(value));
+        if (value >> 32) limbs.push_back(static_cast<uint32_t>(value >> 32));
+    }
+
+    bool isZero() const { return limbs.empty(); }
+
+    // this += value * factor
+    void addMultiple(const BigCount& value, uint32_t factor) {
+        if (value.isZero() || factor == 0) return;
+        if (limbs.size() < value.limbs.size()) limbs.resize(value.limbs.size(), 0);
+        uint64_t carry = 0;
+        size_t i = 0;
+        for (; i < value.limbs.size(); i++) {
+            uint64_t t = uint64_t(value.limbs[i]) * factor + limbs[i] + carry;
+            limbs[i] = static_cast<uint32_t>(t);
+            carry = t >> 32;
+        }
+        for (; carry && i < limbs.size(); i++) {
+            uint64_t t = uint64_t(limbs[i]) + carry;
+            limbs[i] = static_cast<uint32_t>(t);
+            carry = t >> 32;
+        }
+        if (carry) limbs.push_back(static_cast<uint32_t>(carry));
+    }
+
+    size_t bitLength() const {
+        if (limbs.empty()) return 0;
+        size_t bits = limbs.size() * 32;
+        for (uint32_t top = limbs.back(); !(top & 0x80000000u); top <<= 1) bits--;
+        return bits;
+    }
+
+    // Bits [shift, shift + 64) as an integer
+    uint64_t bitsFrom(size_t shift) const {
+        size_t index = shift / 32, offset = shift % 32;
+        uint64_t low = limb(index) | uint64_t(limb(index + 1)) << 32;
+        if (offset == 0) return low;
+        return low >> offset | uint64_t(limb(index + 2)) << (64 - offset);
+    }
+
+    // Is any of the bits below `shift` set?
+    bool anyBitsBelow(size_t shift) const {
+        size_t index = shift / 32, offset = shift % 32;
+        for (size_t i = 0; i < index && i < limbs.size(); i++) {
+            if (limbs[i]) return true;
+        }
+        return offset && (limb(index) & ((1u << offset) - 1));
+    }
+
+    int compare(const BigCount& other) const {
+        if (limbs.size() != other.limbs.size()) return limbs.size() < other.limbs.size() ? -1 : 1;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            if (limbs[i] != other.limbs[i]) return limbs[i] < other.limbs[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    double log2() const {
+        size_t bits = bitLength();
+        if (bits <= 64) return bits ? std::log2(static_cast<double>(bitsFrom(0))) : 0;
+        return std::log2(static_cast<double>(bitsFrom(bits - 64))) + static_cast<double>(bits - 64);
+    }
+
+    // high * 2^shift + (uniform random below 2^shift)
+    static BigCount randomBelowPower(RandomSource& source, uint64_t high, size_t shift) {
+        BigCount result;
+        result.limbs.resize((shift + 31) / 32 + 3, 0);
+        source.fill(reinterpret_cast<unsigned char*>(result.limbs.data()), (shift + 31) / 32 * sizeof(uint32_t));
+        size_t index = shift / 32, offset = shift % 32;
+        if (offset) result.limbs[index] &= (1u << offset) - 1;
+        uint64_t low = high << offset;
+        uint64_t top = offset ? high >> (64 - offset) : 0;
+        result.limbs[index] |= static_cast<uint32_t>(low);
+        result.limbs[index + 1] = static_cast<uint32_t>(low >> 32);
+        result.limbs[index + 2] = static_cast<uint32_t>(top);
+        while (!result.limbs.empty() && result.limbs.back() == 0) result.limbs.pop_back();
+        return result;
+    }
+
+    void wipe() {
+        if (!limbs.empty()) secureZero(limbs.data(), limbs.size() * sizeof(uint32_t));
+        limbs.clear();
+    }
+
+private:
+    std::vector<uint32_t> limbs;   // little-endian, no leading zero limbs
+
+    uint32_t limb(size_t i) const { return i < limbs.size() ? limbs[i] : 0; }
+};
+
+// A policy compiled for one length. Immutable once built, so one SitePolicy
+// can serve any number of threads, each with its own RandomSource.
+class SitePolicy {
+public:
+    // Throws std::invalid_argument if the rules contradict each other, no
+    // password of `length` satisfies them, or they are too complex to compile
+    SitePolicy(const PolicyRules& rules, size_t length) : passwordLength(length) {
+        if (length == 0 || length > static_cast<size_t>(POLICY_MAX_LENGTH)) {
+            throw std::invalid_argument("password length must be between 1 and " +
+                                        std::to_string(POLICY_MAX_LENGTH));
+        }
+        buildAlphabets(rules);
+        buildStates();
+        count();
+        if (ways[stateIndex(0, startState)].isZero()) {
+            throw std::invalid_argument("no password of length " + std::to_string(length) +
+                                        " satisfies the policy");
+        }
+        buildBounds();
+    }
+
+    SitePolicy(const SitePolicy&) = delete;
+    SitePolicy& operator=(const SitePolicy&) = delete;
+
+    size_t length() const { return passwordLength; }
+
+    // log2 of the number of valid passwords: exact entropy of a draw
+    double entropyBits() const {
+        return ways[stateIndex(0, startState)].log2();
+    }
+
+    // Characters of each class left after exclusions
+    const std::string& alphabet(CharClass charClass) const {
+        return alphabets[static_cast<int>(charClass)];
+    }
+
+    // Write one uniformly drawn valid password of length() characters to
+    // `out` (not NUL-terminated). Safe from any number of threads.
+    void generate(RandomSource& source, char* out) const {
+        size_t state = startState;
+        for (size_t p = 0; p < passwordLength; p++) {
+            const Move& move = moves[pickMove(source, p, state)];
+            const std::string& chars = alphabets[move.charClass];
+            switch (move.kind) {
+                case Fresh:
+                    out[p] = chars[uniformBelow(source, static_cast<uint32_t>(chars.size()))];
+                    break;
+                case Same:
+                    out[p] = out[p - 1];
+                    break;
+                case Other: {
+                    // Any character of the class except the one just written
+                    uint32_t i = uniformBelow(source, static_cast<uint32_t>(chars.size() - 1));
+                    if (i >= static_cast<uint32_t>(chars.find(out[p - 1]))) i++;
+                    out[p] = chars[i];
+                    break;
+                }
+            }
+            state = move.next;
+        }
+    }
+
+private:
+    enum MoveKind : uint8_t {
+        Fresh,   // any character of the class
+        Same,    // repeat the last character
+        Other    // a character of the last one's class, but not it
+    };
+
+    // One way to write the next character, `weight` characters wide
+    struct Move {
+        uint32_t next;
+        uint16_t weight;
+        uint8_t charClass;
+        MoveKind kind;
+    };
+
+    // How pickMove() draws at one (position, state): `bits` random bits,
+    // standing for the top bits of a number below ways[p][s] < 2^(shift + bits)
+    struct Draw {
+        uint32_t shift;
+        uint32_t bits;
+    };
+
+    // Cumulative move weight at one position, divided by 2^shift
+    struct Bound {
+        uint64_t floor;
+        bool inexact;   // the division had a remainder
+    };
+
+    size_t passwordLength;
+    std::string alphabets[4];
+    ClassRule rules[4];
+    uint8_t startClasses = 0;
+
+    // State = per-class counts (mixed radix, each capped at caps[c]) then,
+    // if runs are limited, 0 for "nothing written" or 1 + class * maxRepeat
+    // + (run - 1)
+    int caps[4];
+    bool capped[4];            // caps[c] is a hard maximum, not "enough"
+    size_t maxRepeat = 0;
+    size_t tailStates = 1;
+    size_t stateCount = 0;
+    size_t startState = 0;
+
+    std::vector<size_t> moveStart;   // per state, into moves; stateCount + 1 entries
+    std::vector<Move> moves;
+    std::vector<BigCount> ways;      // [p * stateCount + s], p = 0 .. passwordLength
+    std::vector<Draw> draws;         // [p * stateCount + s], p < passwordLength
+    std::vector<Bound> bounds;       // [p * moves.size() + move]
+
+    size_t stateIndex(size_t p, size_t state) const {
+        return p * stateCount + state;
+    }
+
+    bool allowedAt(size_t p, const Move& move) const {
+        return p > 0 || !startClasses || (startClasses & classBit(move.charClass));
+    }
+
+    static uint8_t classBit(int charClass) {
+        static const uint8_t bits[4] = { CLASS_UPPER, CLASS_LOWER, CLASS_DIGIT, CLASS_SPECIAL };
+        return bits[charClass];
+    }
+
+    void buildAlphabets(const PolicyRules& policy) {
+        static const char* const sets[4] = { UPPERCASE, LOWERCASE, DIGITS, SPECIAL };
+        for (int c = 0; c < 4; c++) {
+            for (const char* s = sets[c]; *s; s++) {
+                if (policy.exclude.find(*s) == std::string::npos) alphabets[c] += *s;
+            }
+            rules[c] = policy.classes[c];
+            if (rules[c].max >= 0 && rules[c].min > rules[c].max) {
+                throw std::invalid_argument("a class's minimum is above its maximum");
+            }
+            if (alphabets[c].empty()) rules[c].max = 0;   // excluded entirely
+        }
+        if (policy.maxRepeat < 0) {
+            throw std::invalid_argument("max-repeat can't be negative");
+        }
+        maxRepeat = static_cast<size_t>(policy.maxRepeat);
+        if (maxRepeat >= passwordLength) maxRepeat = 0;   // no run can be that long anyway
+        startClasses = policy.startClasses;
+    }
+
+    void buildStates() {
+        uint64_t countStates = 1;
+        for (int c = 0; c < 4; c++) {
+            // Track up to the maximum where there is one below the length,
+            // otherwise only up to the minimum ("enough")
+            capped[c] = rules[c].max >= 0 && static_cast<size_t>(rules[c].max) < passwordLength;
+            int cap = capped[c] ? rules[c].max : rules[c].min;
+            caps[c] = static_cast<int>(std::min<size_t>(static_cast<size_t>(cap), passwordLength));
+            countStates *= static_cast<uint64_t>(caps[c]) + 1;
+        }
+        tailStates = maxRepeat ? 1 + 4 * maxRepeat : 1;
+        uint64_t states = countStates * tailStates;
+        if (states * (passwordLength + 1) > POLICY_MAX_TABLE) {
+            throw std::invalid_argument("the policy is too complex to compile; loosen the per-class maximums");
+        }
+        stateCount = static_cast<size_t>(states);
+        startState = 0;
+
+        moveStart.assign(stateCount + 1, 0);
+        for (size_t s = 0; s < stateCount; s++) {
+            moveStart[s] = moves.size();
+            addMoves(s);
+        }
+        moveStart[stateCount] = moves.size();
+    }
+
+    // Every way to extend state `s` by one character
+    void addMoves(size_t s) {
+        size_t tail = s % tailStates;
+        size_t counts = s / tailStates;
+        int lastClass = -1;
+        size_t run = 0;
+        if (maxRepeat && tail > 0) {
+            lastClass = static_cast<int>((tail - 1) / maxRepeat);
+            run = (tail - 1) % maxRepeat + 1;
+        }
+
+        size_t radix = 1;
+        for (int c = 0; c < 4; c++) {
+            size_t value = counts / radix % (static_cast<size_t>(caps[c]) + 1);
+            size_t nextCounts = counts;
+            if (static_cast<int>(value) < caps[c]) {
+                nextCounts += radix;
+            } else if (capped[c] || alphabets[c].empty()) {
+                radix *= static_cast<size_t>(caps[c]) + 1;
+                continue;   // at the class maximum
+            }
+            radix *= static_cast<size_t>(caps[c]) + 1;
+            size_t n = alphabets[c].size();
+
+            if (!maxRepeat) {
+                moves.push_back(Move{ static_cast<uint32_t>(nextCounts), static_cast<uint16_t>(n),
+                                      static_cast<uint8_t>(c), Fresh });
+                continue;
+            }
+            size_t freshTail = 1 + c * maxRepeat;
+            if (c != lastClass) {
+                moves.push_back(Move{ static_cast<uint32_t>(nextCounts * tailStates + freshTail),
+                                      static_cast<uint16_t>(n), static_cast<uint8_t>(c), Fresh });
+                continue;
+            }
+            if (run < maxRepeat) {
+                moves.push_back(Move{ static_cast<uint32_t>(nextCounts * tailStates + freshTail + run),
+                                      1, static_cast<uint8_t>(c), Same });
+            }
+            if (n > 1) {
+                moves.push_back(Move{ static_cast<uint32_t>(nextCounts * tailStates + freshTail),
+                                      static_cast<uint16_t>(n - 1), static_cast<uint8_t>(c), Other });
+            }
+        }
+    }
+
+    bool accepting(size_t s) const {
+        size_t counts = s / tailStates;
+        for (int c = 0; c < 4; c++) {
+            size_t value = counts % (static_cast<size_t>(caps[c]) + 1);
+            counts /= static_cast<size_t>(caps[c]) + 1;
+            if (static_cast<int>(value) < rules[c].min) return false;
+        }
+        return true;
+    }
+
+    // ways[p][s] from the end back to the start
+    void count() {
+        ways.assign((passwordLength + 1) * stateCount, BigCount());
+        for (size_t s = 0; s < stateCount; s++) {
+            if (accepting(s)) ways[stateIndex(passwordLength, s)] = BigCount(1);
+        }
+        for (size_t p = passwordLength; p-- > 0;) {
+            for (size_t s = 0; s < stateCount; s++) {
+                BigCount& total = ways[stateIndex(p, s)];
+                for (size_t m = moveStart[s]; m < moveStart[s + 1]; m++) {
+                    if (allowedAt(p, moves[m])) {
+                        total.addMultiple(ways[stateIndex(p + 1, moves[m].next)], moves[m].weight);
+                    }
+                }
+            }
+        }
+    }
+
+    // Top 64 bits of every cumulative move weight, so that picking a move
+    // usually needs one 64-bit draw instead of arbitrary precision
+    void buildBounds() {
+        draws.assign(passwordLength * stateCount, Draw{ 0, 0 });
+        bounds.assign(passwordLength * moves.size(), Bound{ 0, false });
+        for (size_t p = 0; p < passwordLength; p++) {
+            for (size_t s = 0; s < stateCount; s++) {
+                const BigCount& total = ways[stateIndex(p, s)];
+                if (total.isZero()) continue;
+                size_t bits = total.bitLength();
+                size_t shift = bits > 64 ? bits - 64 : 0;
+                draws[stateIndex(p, s)] = Draw{ static_cast<uint32_t>(shift), static_cast<uint32_t>(bits - shift) };
+                BigCount cumulative;
+                for (size_t m = moveStart[s]; m < moveStart[s + 1]; m++) {
+                    if (allowedAt(p, moves[m])) {
+                        cumulative.addMultiple(ways[stateIndex(p + 1, moves[m].next)], moves[m].weight);
+                    }
+                    bounds[p * moves.size() + m] = Bound{ cumulative.bitsFrom(shift), cumulative.anyBitsBelow(shift) };
+                }
+            }
+        }
+    }
+
+    // Pick the move out of state `s` at position `p` with probability
+    // weight * ways[p + 1][next] / ways[p][s]. Conceptually r is uniform
+    // below ways[p][s] and the move is the bucket r falls in. Only the top
+    // 64 bits `u` of r are drawn first; they settle the bucket unless
+    // [u, u + 1) * 2^shift straddles a bucket edge, and only then are the
+    // remaining bits drawn (probability about 2^-60 per character).
+    size_t pickMove(RandomSource& source, size_t p, size_t s) const {
+        const size_t first = moveStart[s], last = moveStart[s + 1];
+        const Bound* bound = bounds.data() + p * moves.size();
+        const Draw draw = draws[stateIndex(p, s)];
+        const Bound& total = bound[last - 1];
+        for (;;) {
+            uint64_t u = draw.bits == 64 ? source() : source() >> (64 - draw.bits);
+            for (size_t m = first; m < last; m++) {
+                if (u < bound[m].floor) {
+                    // Inside bucket m unless the previous edge cuts [u, u + 1)
+                    if (m == first || u > bound[m - 1].floor || !bound[m - 1].inexact) return m;
+                    return pickExact(source, p, s, u, draw.shift);
+                }
+            }
+            // At or past the end of the last bucket: reject, or decide exactly
+            if (u == total.floor && total.inexact) {
+                size_t m = pickExact(source, p, s, u, draw.shift);
+                if (m != last) return m;
+            }
+        }
+    }
+
+    // The slow path of pickMove(): draw r's low bits and compare exactly.
+    // Returns moveStart[s + 1] if r is past the last bucket (redraw).
+    size_t pickExact(RandomSource& source, size_t p, size_t s, uint64_t u, size_t shift) const {
+        BigCount r = BigCount::randomBelowPower(source, u, shift);
+        BigCount cumulative;
+        size_t m = moveStart[s];
+        for (; m < moveStart[s + 1]; m++) {
+            if (allowedAt(p, moves[m])) {
+                cumulative.addMultiple(ways[stateIndex(p + 1, moves[m].next)], moves[m].weight);
+            }
+            if (r.compare(cumulative) < 0) break;
+        }
+        r.wipe();
+        return m;
+    }
+};
+
+// Draws passwords under a SitePolicy. Not thread-safe: give each thread its
+// own generator, as with PassphraseGenerator; they can share the policy.
+class SitePolicyGenerator {
+public:
+    // `seed` is only used by RandomBackend::Seeded
+    explicit SitePolicyGenerator(const SitePolicy& sitePolicy, RandomBackend backend = RandomBackend::ChaCha20,
+                                 uint64_t seed = 0)
+        : policy(sitePolicy), source(makeRandomSource(backend, seed)),
+          seeded(backend == RandomBackend::Seeded ? static_cast<SeededRandom*>(source.get()) : nullptr) {}
+
+    // Seeded backend only: make the next password the `index`-th of the
+    // seed's stream, as pwgen_seek() does
+    void seek(uint64_t index, uint32_t retry = 0) {
+        if (seeded) seeded->seek(index, retry);
+    }
+
+    // Write one password of policy().length() characters to `out`
+    void generate(char* out) {
+        if (seeded) seeded->beginPassword();
+        policy.generate(*source, out);
+    }
+
+    const SitePolicy& sitePolicy() const { return policy; }
+
+private:
+    const SitePolicy& policy;
+    std::unique_ptr<RandomSource> source;
+    SeededRandom* seeded;   // `source`, if seeded
+
+    SitePolicyGenerator(const SitePolicyGenerator&);
+    SitePolicyGenerator& operator=(const SitePolicyGenerator&);
+};
+
+} // namespace pwgen
+
+#endif // PWGEN_SITE_POLICY_H
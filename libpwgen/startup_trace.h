@@ -0,0 +1,180 @@
+#ifndef PWGEN_STARTUP_TRACE_H
+#define PWGEN_STARTUP_TRACE_H
+
+// Scoped startup timers for the front ends, dumped as Chrome trace-event JSON
+// (load the file in ui.perfetto.dev or chrome://tracing).
+//
+// Only built with -DPWGEN_STARTUP_TRACE (qmake: CONFIG+=startup_trace).
+// Otherwise PWGEN_TRACE_SCOPE() expands to nothing and setStartupTraceOutput()
+// just reports that tracing isn't available.
+//
+//   PWGEN_TRACE_SESSION();             // top of main(): writes the file on exit
+//   PWGEN_TRACE_SCOPE("loadSettings"); // times the enclosing block
+//   PWGEN_TRACE_MARK("firstEvent");    // an event from trace start to now
+//
+// Time zero is the first use of the tracer, normally PWGEN_TRACE_SESSION()
+// at the top of main(). That is after exec, the dynamic loader and static
+// initialization, which the trace doesn't cover. Events go into a fixed
+// array, so a scope costs two clock reads and no allocation. They are
+// recorded from the start; the output path can be set later (e.g. once
+// --startup-trace is parsed). The file is written from an atexit() hook, so
+// runs that end in exit() rather than returning from main() still get one.
+
+#ifdef PWGEN_STARTUP_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace pwgen {
+
+class StartupTrace {
+public:
+    static const size_t MAX_EVENTS = 256;
+
+    StartupTrace() : epoch(std::chrono::steady_clock::now()), used(0) {}
+
+    void setOutput(const std::string& path) { output = path; }
+
+    // Microseconds since the trace started (its first use, not exec)
+    int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(const char* name, int64_t start, int64_t end) {
+        size_t slot = used.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= MAX_EVENTS) return;
+        Event& event = events[slot];
+        event.name = name;
+        event.start = start;
+        event.duration = end - start;
+        event.thread = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xffffffff);
+    }
+
+    // Record an event spanning everything since the trace started
+    void mark(const char* name) { record(name, 0, now()); }
+
+    // Write the recorded events if an output path was set; false on I/O error
+    bool write() const {
+        if (output.empty()) return true;
+        FILE* file = fopen(output.c_str(), "w");
+        if (!file) return false;
+
+#if defined(_WIN32)
+        long pid = static_cast<long>(_getpid());
+#else
+        long pid = static_cast<long>(getpid());
+#endif
+        size_t count = std::min(used.load(), MAX_EVENTS);
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        for (size_t i = 0; i < count; i++) {
+            const Event& event = events[i];
+            fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"startup\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,"
+                          "\"pid\":%ld,\"tid\":%lu}\n",
+                    i ? "," : "", event.name, static_cast<long long>(event.start),
+                    static_cast<long long>(event.duration), pid, static_cast<unsigned long>(event.thread));
+        }
+        fprintf(file, "]}\n");
+        return fclose(file) == 0;
+    }
+
+private:
+    // Names are string literals from PWGEN_TRACE_SCOPE, so they need no escaping
+    struct Event {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+        uint32_t thread;
+    };
+
+    std::chrono::steady_clock::time_point epoch;
+    std::atomic<size_t> used;
+    Event events[MAX_EVENTS];
+    std::string output;
+};
+
+inline StartupTrace& startupTrace() {
+    static StartupTrace trace;
+    return trace;
+}
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* scopeName) : name(scopeName), start(startupTrace().now()) {}
+    ~TraceScope() { startupTrace().record(name, start, startupTrace().now()); }
+
+private:
+    const char* name;
+    int64_t start;
+
+    TraceScope(const TraceScope&);
+    TraceScope& operator=(const TraceScope&);
+};
+
+// Starts the clock and writes the trace at process exit, whether main()
+// returns or something calls exit(). The hook is registered after the trace
+// object is built, so it runs before that object is destroyed.
+class TraceSession {
+public:
+    TraceSession() {
+        startupTrace();
+        static bool registered = std::atexit(&TraceSession::writeAtExit) == 0;
+        (void)registered;
+    }
+
+private:
+    static void writeAtExit() {
+        if (!startupTrace().write()) {
+            fprintf(stderr, "Warning: Could not write startup trace.\n");
+        }
+    }
+
+    TraceSession(const TraceSession&);
+    TraceSession& operator=(const TraceSession&);
+};
+
+inline bool setStartupTraceOutput(const std::string& path) {
+    startupTrace().setOutput(path);
+    return true;
+}
+
+} // namespace pwgen
+
+#define PWGEN_TRACE_CONCAT_INNER(a, b) a##b
+#define PWGEN_TRACE_CONCAT(a, b) PWGEN_TRACE_CONCAT_INNER(a, b)
+#define PWGEN_TRACE_SCOPE(name) pwgen::TraceScope PWGEN_TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define PWGEN_TRACE_SESSION() pwgen::TraceSession PWGEN_TRACE_CONCAT(traceSession_, __LINE__)
+#define PWGEN_TRACE_MARK(name) pwgen::startupTrace().mark(name)
+
+#else // !PWGEN_STARTUP_TRACE
+
+#include <string>
+
+namespace pwgen {
+
+inline bool setStartupTraceOutput(const std::string&) {
+    return false;
+}
+
+} // namespace pwgen
+
+#define PWGEN_TRACE_SCOPE(name) do {} while (0)
+#define PWGEN_TRACE_SESSION() do {} while (0)
+#define PWGEN_TRACE_MARK(name) do {} while (0)
+
+#endif // PWGEN_STARTUP_TRACE
+
+#endif // PWGEN_STARTUP_TRACE_H
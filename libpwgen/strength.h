@@ -0,0 +1,143 @@
+#ifndef PWGEN_STRENGTH_H
+#define PWGEN_STRENGTH_H
+
+// Password strength score (0-100) shared by the front ends and benchmarks.
+//
+// The score depends only on the length and on which character classes occur,
+// so it can be accumulated one character at a time with a 256-entry class
+// table (no locale-dependent islower()/isupper() calls), or computed for a
+// whole policy before anything is generated.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pwgen {
+
+// Character class bits
+const uint8_t CLASS_LOWER = 1;
+const uint8_t CLASS_UPPER = 2;
+const uint8_t CLASS_DIGIT = 4;
+const uint8_t CLASS_SPECIAL = 8;
+const uint8_t CLASS_ALL = CLASS_LOWER | CLASS_UPPER | CLASS_DIGIT | CLASS_SPECIAL;
+
+// Byte -> class bit. Anything that isn't an ASCII letter or digit is special.
+struct ClassTable {
+    uint8_t bits[256];
+
+    ClassTable() {
+        for (int c = 0; c < 256; c++) {
+            if (c >= 'a' && c <= 'z') bits[c] = CLASS_LOWER;
+            else if (c >= 'A' && c <= 'Z') bits[c] = CLASS_UPPER;
+            else if (c >= '0' && c <= '9') bits[c] = CLASS_DIGIT;
+            else bits[c] = CLASS_SPECIAL;
+        }
+    }
+};
+
+inline const ClassTable& classTable() {
+    static const ClassTable table;
+    return table;
+}
+
+inline int classCount(uint8_t classes) {
+    return ((classes & CLASS_LOWER) ? 1 : 0) + ((classes & CLASS_UPPER) ? 1 : 0) +
+           ((classes & CLASS_DIGIT) ? 1 : 0) + ((classes & CLASS_SPECIAL) ? 1 : 0);
+}
+
+// Size of the alphabet a password covering `classes` is drawn from, as an
+// attacker who knows only the classes would assume
+inline double classCardinality(uint8_t classes) {
+    double size = 0;
+    if (classes & CLASS_LOWER) size += 26;
+    if (classes & CLASS_UPPER) size += 26;
+    if (classes & CLASS_DIGIT) size += 10;
+    if (classes & CLASS_SPECIAL) size += 33;
+    return size;
+}
+
+// Score from length and class coverage
+inline int scoreFromCoverage(uint8_t classes, size_t length) {
+    if (length == 0) return 0;
+
+    int score = 0;
+
+    // Length contribution (up to 40 points)
+    score += static_cast<int>(std::min<size_t>(40, length * 2));
+
+    // Character variety (up to 30 points)
+    score += classCount(classes) * 7.5;
+
+    // Entropy approximation (up to 30 points)
+    double entropy = log2(classCardinality(classes)) * length;
+    score += std::min(30.0, entropy / 4.0);
+
+    return std::min(100, score);
+}
+
+// Single-pass accumulator: feed characters as they are produced, read the
+// score at any point
+class StrengthMeter {
+public:
+    void add(char c) {
+        classes |= classTable().bits[static_cast<uint8_t>(c)];
+        length++;
+    }
+
+    void add(const char* data, size_t len) {
+        const uint8_t* bits = classTable().bits;
+        uint8_t seen = classes;
+        for (size_t i = 0; i < len; i++) {
+            seen |= bits[static_cast<uint8_t>(data[i])];
+        }
+        classes = seen;
+        length += len;
+    }
+
+    // Account for `len` characters whose classes are already known
+    void addCoverage(uint8_t coverage, size_t len) {
+        classes |= coverage;
+        length += len;
+    }
+
+    uint8_t coverage() const { return classes; }
+
+    size_t size() const { return length; }
+
+    int score() const { return scoreFromCoverage(classes, length); }
+
+    void reset() {
+        classes = 0;
+        length = 0;
+    }
+
+private:
+    uint8_t classes = 0;
+    size_t length = 0;
+};
+
+// Score from length, character variety and an entropy approximation
+inline int calculateStrength(const char* password, size_t length) {
+    StrengthMeter meter;
+    meter.add(password, length);
+    return meter.score();
+}
+
+inline int calculateStrength(const std::string& password) {
+    return calculateStrength(password.data(), password.size());
+}
+
+// Strength description based on score
+inline const char* strengthDescription(int score) {
+    if (score < 30) return "Very Weak";
+    if (score < 50) return "Weak";
+    if (score < 70) return "Moderate";
+    if (score < 90) return "Strong";
+    return "Very Strong";
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_STRENGTH_H
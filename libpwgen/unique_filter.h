@@ -0,0 +1,171 @@
+#ifndef PWGEN_UNIQUE_FILTER_H
+#define PWGEN_UNIQUE_FILTER_H
+
+// Concurrent set of password fingerprints, for duplicate-free bulk output.
+//
+// Each password is reduced to a 64-bit keyed hash and kept in one of 64
+// open-addressing tables, picked by the hash's top bits, each behind its own
+// mutex so generator threads rarely contend. Sized up front for the expected
+// count, with headroom for the uneven spread of passwords over the shards,
+// the whole set costs about 10 bytes per password and never rehashes in the
+// common case.
+//
+// The set lives entirely in memory; nothing spills to disk. That caps a
+// --unique run at what RAM holds: about 10 bytes per password, so 100
+// million need roughly 1 GB and a billion roughly 10 GB.
+//
+// insert() returning false means "draw again". Equal passwords always share
+// a fingerprint, so nothing duplicated gets through. Distinct ones share one
+// with probability about n / 2^64, which only costs a needless redraw. The
+// hash key is random per filter, so that can't be provoked.
+//
+//   pwgen::UniqueFilter seen(count);
+//   while (!seen.insert(slot, length)) regenerate(slot);
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "secure_random.h"
+
+namespace pwgen {
+
+// Redraws allowed for one output before a bulk run gives up; only reached
+// when nearly the whole keyspace has been handed out
+const int UNIQUE_MAX_RETRIES = 1 << 20;
+
+class UniqueFilter {
+public:
+    static const size_t SHARD_COUNT = 64;
+
+    explicit UniqueFilter(uint64_t expected) {
+        systemRandomBytes(reinterpret_cast<unsigned char*>(&key), sizeof(key));
+        // 80% load once `expected` are in. Shard loads vary by about the
+        // square root of the mean; without room for four times that, about
+        // half the shards would double and cost 14 bytes a password.
+        double mean = static_cast<double>(expected) / SHARD_COUNT;
+        size_t perShard = static_cast<size_t>((mean + 4 * std::sqrt(mean) + 16) * 5 / 4) + 1;
+        for (size_t i = 0; i < SHARD_COUNT; i++) {
+            shards[i].slots.assign(perShard, 0);
+        }
+    }
+
+    ~UniqueFilter() {
+        // Fingerprints are keyed, but don't leave them lying around either
+        for (size_t i = 0; i < SHARD_COUNT; i++) {
+            if (!shards[i].slots.empty()) {
+                secureZero(shards[i].slots.data(), shards[i].slots.size() * sizeof(uint64_t));
+            }
+        }
+        secureZero(&key, sizeof(key));
+    }
+
+    // Add a password; false if an equal one was added before. Thread-safe.
+    bool insert(const char* data, size_t length) {
+        uint64_t print = fingerprint(data, length);
+        Shard& shard = shards[print >> 58];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if ((shard.used + 1) * 5 > shard.slots.size() * 4) {
+            grow(shard);
+        }
+        if (!place(shard.slots, print)) {
+            return false;
+        }
+        shard.used++;
+        return true;
+    }
+
+    uint64_t size() const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < SHARD_COUNT; i++) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            total += shards[i].used;
+        }
+        return total;
+    }
+
+    size_t memoryBytes() const {
+        size_t total = 0;
+        for (size_t i = 0; i < SHARD_COUNT; i++) {
+            std::lock_guard<std::mutex> lock(shards[i].mutex);
+            total += shards[i].slots.size() * sizeof(uint64_t);
+        }
+        return total;
+    }
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::vector<uint64_t> slots;   // 0 = empty
+        size_t used = 0;
+    };
+
+    uint64_t key = 0;
+    Shard shards[SHARD_COUNT];
+
+    UniqueFilter(const UniqueFilter&);
+    UniqueFilter& operator=(const UniqueFilter&);
+
+    // Keyed FNV-1a with a splitmix64 finish, so every bit (including the top
+    // six that pick the shard) depends on every byte
+    uint64_t fingerprint(const char* data, size_t length) const {
+        uint64_t h = 0xcbf29ce484222325ULL ^ key;
+        for (size_t i = 0; i < length; i++) {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 0x100000001b3ULL;
+        }
+        h ^= length;
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h ? h : 1;
+    }
+
+    // Linear probing from a slot picked by multiply-shift, so table sizes
+    // needn't be powers of two; false if already present
+    static bool place(std::vector<uint64_t>& slots, uint64_t print) {
+        size_t capacity = slots.size();
+        size_t i = static_cast<size_t>((uint64_t(uint32_t(print)) * capacity) >> 32);
+        for (;;) {
+            if (slots[i] == print) return false;
+            if (slots[i] == 0) {
+                slots[i] = print;
+                return true;
+            }
+            if (++i == capacity) i = 0;
+        }
+    }
+
+    // More outputs than expected (redraws, or an undersized guess): double
+    static void grow(Shard& shard) {
+        std::vector<uint64_t> bigger(shard.slots.size() * 2, 0);
+        for (uint64_t print : shard.slots) {
+            if (print) place(bigger, print);
+        }
+        secureZero(shard.slots.data(), shard.slots.size() * sizeof(uint64_t));
+        shard.slots.swap(bigger);
+    }
+};
+
+// Expected redraws when drawing uniformly from `keyspaceBits` bits of
+// keyspace until `count` distinct values are in hand: the sum over k < count
+// of k / (N - k), about N ln(N / (N - count)) - count. Infinite if count > N.
+inline double expectedDuplicates(double keyspaceBits, double count) {
+    double n = std::exp2(keyspaceBits);
+    if (count > n) return INFINITY;
+    if (count >= n) return n * (std::log(n) + 0.5772156649) - n;   // N H_N - N
+    double x = count / n;
+    if (x < 1e-4) {
+        // Series of the same, without the cancellation: count^2 / 2N + ...
+        return count * x * (0.5 + x / 3 + x * x / 4);
+    }
+    return -n * std::log1p(-x) - count;
+}
+
+} // namespace pwgen
+
+#endif // PWGEN_UNIQUE_FILTER_H
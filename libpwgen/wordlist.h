@@ -0,0 +1,243 @@
+#ifndef PWGEN_WORDLIST_H
+#define PWGEN_WORDLIST_H
+
+// Memory-mapped wordlist for diceware-style passphrases.
+//
+// Wordlists are compiled ahead of time by dict/pwwordsc.cpp into a flat,
+// offset-indexed blob: a header, wordCount + 1 byte offsets, then every word's
+// bytes back to back. At runtime the file is mapped read-only, so opening a
+// 100k-word list costs one mmap() and a pass over its offsets, and word(i) is
+// two loads.
+//
+//   pwgen::PassphraseGenerator phrases(pwgen::defaultWordlist());
+//   pwgen::SecureBytes phrase = phrases.generate(6, "-");
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "dictionary.h"
+#include "index_sampler.h"
+#include "secure_memory.h"
+#include "secure_random.h"
+
+namespace pwgen {
+
+const char WORDS_MAGIC[8] = { 'P', 'W', 'W', 'O', 'R', 'D', 'S', '\1' };
+const uint32_t WORDS_VERSION = 1;
+const uint32_t WORDS_BYTE_ORDER = 0x01020304;
+const size_t WORDS_MAX_WORD = 64;
+
+// File layout: WordsHeader, uint32_t offsets[wordCount + 1], word bytes
+// (offsets are relative to the first word byte), padding to 4 bytes.
+struct WordsHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;   // WORDS_BYTE_ORDER as written by the compiler
+    uint32_t wordCount;
+    uint32_t bytesSize;   // bytes of word text
+    uint32_t maxWord;     // longest word, in bytes
+    uint32_t totalSize;   // whole file
+};
+
+class Wordlist {
+public:
+    Wordlist() {}
+
+    ~Wordlist() { close(); }
+
+    // Map a compiled wordlist; false (and an empty list) if the file is
+    // missing or malformed
+    bool open(const std::string& path) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(WordsHeader))) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        base = static_cast<const unsigned char*>(mapped);
+        size = static_cast<size_t>(st.st_size);
+        isMapped = true;
+#else
+        // No mmap(): read the blob into one buffer, still without parsing it
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+        unsigned char chunk[65536];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            copy.insert(copy.end(), chunk, chunk + got);
+        }
+        fclose(file);
+        base = copy.data();
+        size = copy.size();
+#endif
+        if (!validate()) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (isMapped) munmap(const_cast<unsigned char*>(base), size);
+#endif
+        isMapped = false;
+        copy.clear();
+        base = nullptr;
+        size = 0;
+        header = nullptr;
+        offsets = nullptr;
+        text = nullptr;
+    }
+
+    bool empty() const { return header == nullptr; }
+
+    size_t wordCount() const { return header ? header->wordCount : 0; }
+
+    size_t maxWordLength() const { return header ? header->maxWord : 0; }
+
+    // Average word length, for sizing output buffers
+    double averageWordLength() const {
+        return header && header->wordCount ? double(header->bytesSize) / header->wordCount : 0.0;
+    }
+
+    // Word `index` (< wordCount()), not NUL-terminated
+    const char* word(size_t index, size_t& length) const {
+        length = offsets[index + 1] - offsets[index];
+        return text + offsets[index];
+    }
+
+private:
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    bool isMapped = false;
+    std::vector<unsigned char> copy;
+
+    const WordsHeader* header = nullptr;
+    const uint32_t* offsets = nullptr;
+    const char* text = nullptr;
+
+    Wordlist(const Wordlist&);
+    Wordlist& operator=(const Wordlist&);
+
+    // Bounds-check the blob once so word() can trust every offset
+    bool validate() {
+        const WordsHeader* h = reinterpret_cast<const WordsHeader*>(base);
+        if (memcmp(h->magic, WORDS_MAGIC, sizeof(WORDS_MAGIC)) != 0) return false;
+        if (h->version != WORDS_VERSION || h->byteOrder != WORDS_BYTE_ORDER) return false;
+        if (h->totalSize != size || h->wordCount == 0) return false;
+        if (h->maxWord == 0 || h->maxWord > WORDS_MAX_WORD) return false;
+
+        uint64_t needed = sizeof(WordsHeader) + (uint64_t(h->wordCount) + 1) * sizeof(uint32_t) +
+                          h->bytesSize;
+        if (needed > size) return false;
+
+        const uint32_t* o = reinterpret_cast<const uint32_t*>(base + sizeof(WordsHeader));
+        if (o[0] != 0 || o[h->wordCount] != h->bytesSize) return false;
+        for (uint32_t i = 0; i < h->wordCount; i++) {
+            if (o[i + 1] <= o[i] || o[i + 1] - o[i] > h->maxWord) return false;
+        }
+
+        header = h;
+        offsets = o;
+        text = reinterpret_cast<const char*>(o + h->wordCount + 1);
+        return true;
+    }
+};
+
+// Process-wide wordlist, mapped on first use from $PWGEN_WORDS, then
+// pwgen.words beside the executable, then PWGEN_DICT_DIR. Stays empty if none
+// of them exists; callers report that passphrases are unavailable.
+inline const Wordlist& defaultWordlist() {
+    struct Loader {
+        Wordlist wordlist;
+        Loader() {
+            const char* env = getenv("PWGEN_WORDS");
+            if (env && *env && wordlist.open(env)) return;
+            std::string beside = executableSiblingPath("pwgen.words");
+            if (!beside.empty() && wordlist.open(beside)) return;
+            wordlist.open(PWGEN_DICT_DIR "/pwgen.words");
+        }
+    };
+    static const Loader loader;
+    return loader.wordlist;
+}
+
+// Draws words uniformly (and independently) from a wordlist. Not thread-safe:
+// give each thread its own generator, as with pwgen_ctx.
+class PassphraseGenerator {
+public:
+    // `seed` is only used by RandomBackend::Seeded
+    explicit PassphraseGenerator(const Wordlist& wordlist, RandomBackend backend = RandomBackend::ChaCha20,
+                                 uint64_t seed = 0)
+        : words(wordlist), source(makeRandomSource(backend, seed)),
+          seeded(backend == RandomBackend::Seeded ? static_cast<SeededRandom*>(source.get()) : nullptr) {}
+
+    // Seeded backend only: make the next passphrase the `index`-th of the
+    // seed's stream, as pwgen_seek() does for passwords
+    void seek(uint64_t index, uint32_t retry = 0) {
+        if (seeded) seeded->seek(index, retry);
+    }
+
+    // Append `count` words joined by `separator` to `out`
+    void append(size_t count, const std::string& separator, SecureBytes& out) {
+        if (seeded) seeded->beginPassword();
+        uint32_t bound = static_cast<uint32_t>(words.wordCount());
+        for (size_t i = 0; i < count; i++) {
+            if (i > 0) out.insert(out.end(), separator.begin(), separator.end());
+            size_t length;
+            const char* word = words.word(uniformBelow(*source, bound), length);
+            out.insert(out.end(), word, word + length);
+        }
+    }
+
+    SecureBytes generate(size_t count, const std::string& separator) {
+        SecureBytes phrase;
+        phrase.reserve(maxLength(count, separator));
+        append(count, separator, phrase);
+        return phrase;
+    }
+
+    // Upper bound on a passphrase's length, for sizing buffers
+    size_t maxLength(size_t count, const std::string& separator) const {
+        return count ? count * words.maxWordLength() + (count - 1) * separator.size() : 0;
+    }
+
+    // Exact entropy of a `count`-word passphrase: the separator is public
+    // and every word an independent uniform draw
+    double entropyBits(size_t count) const {
+        return count * std::log2(static_cast<double>(words.wordCount()));
+    }
+
+private:
+    const Wordlist& words;
+    std::unique_ptr<RandomSource> source;
+    SeededRandom* seeded;   // `source`, if seeded
+
+    PassphraseGenerator(const PassphraseGenerator&);
+    PassphraseGenerator& operator=(const PassphraseGenerator&);
+};
+
+} // namespace pwgen
+
+#endif // PWGEN_WORDLIST_H
@@ -4,6 +4,7 @@
 #include <QCloseEvent>
 #include <QComboBox>
 #include <QCryptographicHash>
+#include <QFileDialog>
 #include <QFont>
 #include <QFontDatabase>
 #include <QHBoxLayout>
@@ -23,11 +24,53 @@
 #include <QWidget>
 #include <QList>
 #include <QDialog>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QScreen>
+#include <QSignalBlocker>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QVariant>
 #include <random>
 #include <QWheelEvent>
 #include <QMouseEvent>
 #include <cmath>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>  // MoveFileExW for the atomic settings rename
+#endif
+
+#include "libpwgen/pwgen.h"
+#include "libpwgen/breach.h"
+#include "libpwgen/password_pool.h"
+#include "libpwgen/estimator.h"
+#include "libpwgen/secure_memory.h"
+#include "libpwgen/secure_random.h"
+#include "libpwgen/site_policy.h"
+#include "libpwgen/startup_trace.h"
+#include "libpwgen/wordlist.h"
+
+// Passwords kept by the application (the history) live in the secure arena:
+// locked, left out of core dumps and wiped when freed. Only the copies Qt
+// needs for display are ordinary QStrings.
+static pwgen::SecureBytes toSecureBytes(const QString &text) {
+    QByteArray utf8 = text.toUtf8();
+    pwgen::SecureBytes bytes(utf8.constData(), utf8.constData() + utf8.size());
+    pwgen::secureZero(utf8.data(), utf8.size());
+    return bytes;
+}
+
+static QString fromSecureBytes(const pwgen::SecureBytes &bytes) {
+    return QString::fromUtf8(bytes.data(), static_cast<int>(bytes.size()));
+}
 
 // Custom secure password field with additional security features
 class SecurePasswordField : public QLineEdit {
@@ -88,10 +131,137 @@ private:
     QTimer *clipboardTimer;
 };
 
+// Settings kept in memory and written behind. Changes only mark the store
+// dirty; it is flushed at most once per interval on a worker thread, into a
+// temporary INI file that atomically replaces the real one.
+class SettingsStore : public QObject {
+    Q_OBJECT
+public:
+    explicit SettingsStore(int flushIntervalMs, QObject *parent = nullptr) : QObject(parent) {
+        QSettings settings;
+        path = settings.fileName();
+        for (const QString &key : settings.allKeys()) {
+            values.insert(key, settings.value(key));
+        }
+        
+        flushTimer = new QTimer(this);
+        flushTimer->setSingleShot(true);
+        flushTimer->setInterval(flushIntervalMs);
+        connect(flushTimer, &QTimer::timeout, this, &SettingsStore::flush);
+        connect(&flushWatcher, &QFutureWatcher<bool>::finished, this, &SettingsStore::flushFinished);
+    }
+    
+    bool contains(const QString &key) const {
+        return values.contains(key);
+    }
+    
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const {
+        return values.value(key, defaultValue);
+    }
+    
+    void setValue(const QString &key, const QVariant &value) {
+        auto it = values.constFind(key);
+        if (it != values.constEnd() && it.value() == value) {
+            return;
+        }
+        values.insert(key, value);
+        dirty = true;
+        
+        // Not restarted by later changes, so a slider drag costs one write
+        if (!flushTimer->isActive()) {
+            flushTimer->start();
+        }
+    }
+    
+    // Write everything now, on the calling thread (used on close)
+    void flushNow() {
+        flushTimer->stop();
+        if (flushInFlight) {
+            flushWatcher.waitForFinished();
+            flushInFlight = false;
+            if (!flushWatcher.result()) {
+                dirty = true;
+            }
+        }
+        if (dirty) {
+            dirty = !writeFile(path, values);
+        }
+    }
+    
+private slots:
+    void flush() {
+        if (!dirty || flushInFlight) {
+            return;  // flushFinished() reschedules if needed
+        }
+        
+        dirty = false;
+        flushInFlight = true;
+        QMap<QString, QVariant> snapshot = values;
+        QString target = path;
+        flushWatcher.setFuture(QtConcurrent::run([snapshot, target]() {
+            return SettingsStore::writeFile(target, snapshot);
+        }));
+    }
+    
+    void flushFinished() {
+        if (!flushInFlight) {
+            return;  // Already collected by flushNow()
+        }
+        flushInFlight = false;
+        if (!flushWatcher.result()) {
+            dirty = true;  // Try again on the next interval
+        }
+        if (dirty && !flushTimer->isActive()) {
+            flushTimer->start();
+        }
+    }
+    
+private:
+    QString path;
+    QMap<QString, QVariant> values;
+    bool dirty = false;
+    bool flushInFlight = false;
+    QTimer *flushTimer;
+    QFutureWatcher<bool> flushWatcher;
+    
+    static bool replaceFile(const QString &from, const QString &to) {
+#ifdef Q_OS_WIN
+        return MoveFileExW(reinterpret_cast<const wchar_t *>(from.utf16()),
+                           reinterpret_cast<const wchar_t *>(to.utf16()),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+    }
+    
+    // Runs on a worker thread: touches nothing but its arguments
+    static bool writeFile(const QString &target, const QMap<QString, QVariant> &snapshot) {
+        QDir().mkpath(QFileInfo(target).absolutePath());
+        QString temp = target + ".tmp";
+        {
+            QSettings out(temp, QSettings::IniFormat);
+            out.clear();
+            for (auto it = snapshot.constBegin(); it != snapshot.constEnd(); ++it) {
+                out.setValue(it.key(), it.value());
+            }
+            out.sync();
+            if (out.status() != QSettings::NoError) {
+                QFile::remove(temp);
+                return false;
+            }
+        }
+        if (!replaceFile(temp, target)) {
+            QFile::remove(temp);
+            return false;
+        }
+        return true;
+    }
+};
+
 class PasswordHistoryDialog : public QDialog {
     Q_OBJECT
 public:
-    PasswordHistoryDialog(const QList<QString>& history, QWidget* parent = nullptr)
+    PasswordHistoryDialog(const QList<pwgen::SecureBytes>& history, QWidget* parent = nullptr)
         : QDialog(parent) {
         setWindowTitle("Password History");
         setMinimumWidth(400);
@@ -102,7 +272,7 @@ public:
         
         historyList = new QListWidget(this);
         for (int i = history.size() - 1; i >= 0; --i) {
-            historyList->addItem(history[i]);
+            historyList->addItem(fromSecureBytes(history[i]));
         }
         
         if (!history.isEmpty()) {
@@ -144,6 +314,7 @@ class PasswordGenerator : public QMainWindow {
 
 public:
     PasswordGenerator(QWidget *parent = nullptr) : QMainWindow(parent) {
+        PWGEN_TRACE_SCOPE("PasswordGenerator");
         setWindowTitle("Secure Password Generator");
         
         // Initialize settings with proper format
@@ -197,7 +368,7 @@ public:
         // Password length controls
         auto *lengthLayout = new QHBoxLayout();
         lengthLayout->setSpacing(4);
-        auto *lengthLabel = new QLabel("Length:");
+        lengthLabel = new QLabel("Length:");
         lengthLabel->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
         
         lengthValue = new QLabel("20");
@@ -223,6 +394,7 @@ public:
         includeLowercase = new QCheckBox("Lowercase");
         includeDigits = new QCheckBox("Digits");
         includeSpecial = new QCheckBox("Special");
+        usePassphrase = new QCheckBox("Passphrase (words)");
         
         includeUppercase->setChecked(true);
         includeLowercase->setChecked(true);
@@ -233,6 +405,7 @@ public:
         charsetLayout->addWidget(includeLowercase, 0, 1);
         charsetLayout->addWidget(includeDigits, 1, 0);
         charsetLayout->addWidget(includeSpecial, 1, 1);
+        charsetLayout->addWidget(usePassphrase, 2, 0, 1, 2);
         basicLayout->addLayout(charsetLayout);
         
         // Button layout - main operations
@@ -270,14 +443,9 @@ public:
         fontComboBox = new QComboBox();
         fontComboBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
         
-        QFontDatabase fontDatabase;
-        const QStringList fontFamilies = fontDatabase.families();
-        fontComboBox->addItems(fontFamilies);
-        
-        int arialIndex = fontComboBox->findText("Arial", Qt::MatchContains);
-        if (arialIndex != -1) {
-            fontComboBox->setCurrentIndex(arialIndex);
-        }
+        // Only the current family until the Advanced tab is first opened;
+        // enumerating every installed font is the slowest part of startup
+        fontComboBox->addItem("Arial");
         
         fontLayout->addWidget(fontLabel);
         fontLayout->addWidget(fontComboBox);
@@ -296,6 +464,23 @@ public:
         advancedLayout->addWidget(avoidSimilarChars);
         advancedLayout->addWidget(autoClearClipboard);
         
+        // Site policy file: rules every generated password must satisfy
+        auto *policyLayout = new QHBoxLayout();
+        policyLayout->setSpacing(4);
+        auto *policyLabel = new QLabel("Site policy:");
+        policyLabel->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Preferred);
+        sitePolicyName = new QLabel("None");
+        sitePolicyName->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+        loadPolicyButton = new QPushButton("Load...");
+        clearPolicyButton = new QPushButton("Clear");
+        clearPolicyButton->setEnabled(false);
+        
+        policyLayout->addWidget(policyLabel);
+        policyLayout->addWidget(sitePolicyName);
+        policyLayout->addWidget(loadPolicyButton);
+        policyLayout->addWidget(clearPolicyButton);
+        advancedLayout->addLayout(policyLayout);
+        
         // Add "Save Settings" button to advanced tab
         saveSettingsButton = new QPushButton("Save Current Settings as Default");
         advancedLayout->addWidget(saveSettingsButton);
@@ -311,8 +496,24 @@ public:
         tabLayout->addTab(advancedTab, "Advanced");
         layout->addWidget(tabLayout);
         
+        connect(tabLayout, &QTabWidget::currentChanged, this, [this, tabLayout, advancedTab](int index) {
+            if (tabLayout->widget(index) == advancedTab) {
+                loadFontList();
+            }
+        });
+        
+        // Strength is scored on a worker thread after a short pause in typing;
+        // only the newest text is ever applied to the meter
+        strengthDebounce = new QTimer(this);
+        strengthDebounce->setSingleShot(true);
+        strengthDebounce->setInterval(40);
+        strengthWatcher = new QFutureWatcher<int>(this);
+        connect(strengthDebounce, &QTimer::timeout, this, &PasswordGenerator::startStrengthEvaluation);
+        connect(strengthWatcher, &QFutureWatcher<int>::finished, this, &PasswordGenerator::strengthEvaluated);
+        
         // Set up connections
         connect(lengthSlider, &QSlider::valueChanged, this, &PasswordGenerator::updateLengthLabel);
+        connect(usePassphrase, &QCheckBox::toggled, this, &PasswordGenerator::updatePassphraseMode);
         connect(fontComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), 
                 this, &PasswordGenerator::updateFont);
         connect(generateButton, &QPushButton::clicked, this, &PasswordGenerator::generateNewPassword);
@@ -325,6 +526,8 @@ public:
         // Connect settings buttons
         connect(saveSettingsButton, &QPushButton::clicked, this, &PasswordGenerator::saveSettingsWithConfirmation);
         connect(resetSettingsButton, &QPushButton::clicked, this, &PasswordGenerator::resetSettings);
+        connect(loadPolicyButton, &QPushButton::clicked, this, &PasswordGenerator::chooseSitePolicy);
+        connect(clearPolicyButton, &QPushButton::clicked, this, &PasswordGenerator::clearSitePolicy);
         
         // Connections for auto-saving settings on change
         connect(lengthSlider, &QSlider::valueChanged, this, &PasswordGenerator::autoSaveSettings);
@@ -332,6 +535,7 @@ public:
         connect(includeLowercase, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
         connect(includeDigits, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
         connect(includeSpecial, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
+        connect(usePassphrase, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
         connect(enforceMinimumChars, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
         connect(avoidSimilarChars, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
         connect(autoClearClipboard, &QCheckBox::toggled, this, &PasswordGenerator::autoSaveSettings);
@@ -370,8 +574,10 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override {
-        // Save all settings including window position/size when closing
+        // Save all settings including window position/size when closing,
+        // and wait for them to reach the disk
         saveSettings();
+        settingsStore->flushNow();
         QMainWindow::closeEvent(event);
     }
 
@@ -380,25 +586,132 @@ private slots:
         lengthValue->setText(QString::number(value));
     }
     
+    // Switch the Basic tab between character passwords and passphrases. The
+    // slider counts words in passphrase mode; each mode keeps its own value.
+    void updatePassphraseMode(bool enabled) {
+        if (enabled && pwgen::defaultWordlist().empty()) {
+            QMessageBox::warning(this, "Passphrases Unavailable",
+                                 "No passphrase wordlist was found. Install pwgen.words next to "
+                                 "the application or set PWGEN_WORDS.");
+            QSignalBlocker blocker(usePassphrase);
+            usePassphrase->setChecked(false);
+            enabled = false;
+        }
+        if (enabled == passphraseMode) {
+            return;
+        }
+        passphraseMode = enabled;
+        
+        {
+            QSignalBlocker blocker(lengthSlider);
+            if (enabled) {
+                savedLength = lengthSlider->value();
+                lengthLabel->setText("Words:");
+                lengthSlider->setRange(3, 12);
+                lengthSlider->setValue(savedWords);
+            } else {
+                savedWords = lengthSlider->value();
+                lengthLabel->setText("Length:");
+                lengthSlider->setRange(12, 64);
+                lengthSlider->setValue(savedLength);
+            }
+        }
+        updateLengthLabel(lengthSlider->value());
+        
+        // Character classes don't apply to words
+        includeUppercase->setEnabled(!enabled);
+        includeLowercase->setEnabled(!enabled);
+        includeDigits->setEnabled(!enabled);
+        includeSpecial->setEnabled(!enabled);
+        removeSpecialCharsButton->setEnabled(!enabled);
+    }
+    
     void updateFont(int) {
         QFont newFont(fontComboBox->currentText(), 12, QFont::Bold);
         passwordField->setFont(newFont);
     }
     
+    // Fill the font picker with every installed family, once, keeping the
+    // current selection (even if that family isn't installed)
+    void loadFontList() {
+        if (fontListLoaded) {
+            return;
+        }
+        fontListLoaded = true;
+        PWGEN_TRACE_SCOPE("loadFontList");
+        
+        QString current = fontComboBox->currentText();
+        QFontDatabase fontDatabase;
+        const QStringList fontFamilies = fontDatabase.families();
+        
+        QSignalBlocker blocker(fontComboBox);
+        fontComboBox->clear();
+        fontComboBox->addItems(fontFamilies);
+        
+        int index = fontComboBox->findText(current);
+        if (index == -1) {
+            index = fontComboBox->findText(current, Qt::MatchContains);
+        }
+        if (index == -1) {
+            fontComboBox->insertItem(0, current);
+            index = 0;
+        }
+        fontComboBox->setCurrentIndex(index);
+    }
+    
+    // Apply a font family without enumerating the installed fonts
+    void selectFont(const QString &fontName) {
+        if (fontListLoaded) {
+            int fontIndex = fontComboBox->findText(fontName, Qt::MatchContains);
+            if (fontIndex != -1) {
+                fontComboBox->setCurrentIndex(fontIndex);
+            }
+        } else {
+            fontComboBox->setItemText(0, fontName);
+        }
+        QFont font(fontName, 12, QFont::Bold);
+        passwordField->setFont(font);
+    }
+    
     void generateNewPassword() {
+        PWGEN_TRACE_SCOPE("generateNewPassword");
+        
         // Save current password to history
         saveToHistory(passwordField->text());
         
-        // Generate a new secure password
-        QString password = generateSecurePassword(
-            lengthSlider->value(),
-            includeUppercase->isChecked(),
-            includeLowercase->isChecked(),
-            includeDigits->isChecked(),
-            includeSpecial->isChecked(),
-            enforceMinimumChars->isChecked(),
-            avoidSimilarChars->isChecked()
-        );
+        // Generate a new secure password (or passphrase), drawing again while
+        // it is a known breached password
+        QString password;
+        bool breached = false;
+        for (int attempt = 0; attempt < pwgen::BREACH_MAX_RETRIES; attempt++) {
+            password = passphraseMode
+                ? generatePassphrase(lengthSlider->value())
+                : !sitePolicyFile.isEmpty()
+                ? generatePolicyPassword(lengthSlider->value())
+                : generateSecurePassword(
+                    lengthSlider->value(),
+                    includeUppercase->isChecked(),
+                    includeLowercase->isChecked(),
+                    includeDigits->isChecked(),
+                    includeSpecial->isChecked(),
+                    enforceMinimumChars->isChecked(),
+                    avoidSimilarChars->isChecked()
+                );
+            breached = !password.isEmpty() && isBreached(password);
+            if (!breached) {
+                break;
+            }
+        }
+        
+        if (breached) {
+            // Every candidate was breached: a known-breached password must
+            // never be shown or copied, so say why there is none instead
+            passwordField->clear();
+            strengthMeter->setValue(0);
+            strengthMeter->setFormat("Only breached passwords - use more length or character types");
+            currentHistoryIndex = -1;
+            return;
+        }
         
         passwordField->setText(password);
         
@@ -414,6 +727,19 @@ private slots:
         currentHistoryIndex = -1;
     }
     
+    void chooseSitePolicy() {
+        QString path = QFileDialog::getOpenFileName(this, "Load Site Policy", sitePolicyFile,
+                                                    "Policy files (*.policy *.txt);;All files (*)");
+        if (!path.isEmpty() && loadSitePolicy(path, true)) {
+            autoSaveSettings();
+        }
+    }
+    
+    void clearSitePolicy() {
+        loadSitePolicy(QString(), false);
+        autoSaveSettings();
+    }
+    
     void removeSpecialChars() {
         // Save the current password for undo history
         saveToHistory(passwordField->text());
@@ -453,7 +779,7 @@ private slots:
                 currentHistoryIndex = 0;
             }
             
-            QString previousPassword = passwordHistory[currentHistoryIndex];
+            QString previousPassword = fromSecureBytes(passwordHistory[currentHistoryIndex]);
             passwordField->setText(previousPassword);
             
             // Copy to clipboard with security measures if enabled
@@ -492,7 +818,7 @@ private slots:
         }
         
         // Set the password from history
-        QString historicalPassword = passwordHistory[currentHistoryIndex];
+        QString historicalPassword = fromSecureBytes(passwordHistory[currentHistoryIndex]);
         passwordField->setText(historicalPassword);
         
         // Copy to clipboard with security measures if enabled
@@ -530,14 +856,55 @@ private slots:
     }
     
     void updatePasswordStrength() {
-        QString password = passwordField->text();
-        if (password.isEmpty()) {
+        // Whatever is being scored now is for older text
+        strengthRequest++;
+        
+        if (passwordField->text().isEmpty()) {
+            strengthDebounce->stop();
             strengthMeter->setValue(0);
             strengthMeter->setFormat("No Password");
             return;
         }
         
-        int score = calculatePasswordStrength(password);
+        strengthDebounce->start();
+    }
+    
+    void startStrengthEvaluation() {
+        // At most one evaluation in flight; strengthEvaluated() picks up
+        // whatever was typed meanwhile
+        if (strengthWatcher->isRunning()) {
+            return;
+        }
+        
+        QString password = passwordField->text();
+        if (password.isEmpty()) {
+            return;
+        }
+        
+        evaluatingRequest = strengthRequest;
+        strengthWatcher->setFuture(QtConcurrent::run([password]() {
+            return PasswordGenerator::calculatePasswordStrength(password);
+        }));
+    }
+    
+    void strengthEvaluated() {
+        if (evaluatingRequest == strengthRequest) {
+            showPasswordStrength(strengthWatcher->result());
+        } else if (!strengthDebounce->isActive()) {
+            // Stale result: score the current text instead
+            startStrengthEvaluation();
+        }
+    }
+    
+    void showPasswordStrength(int score) {
+        if (score == BREACHED_SCORE) {
+            // A full red bar, so it can't be mistaken for a weak score
+            strengthMeter->setValue(strengthMeter->maximum());
+            strengthMeter->setStyleSheet("QProgressBar::chunk { background-color: red; }");
+            strengthMeter->setFormat("Breached - do not use");
+            return;
+        }
+        
         strengthMeter->setValue(score);
         
         if (score < 30) {
@@ -560,6 +927,8 @@ private slots:
     
     // Settings management methods
     void initSettings() {
+        PWGEN_TRACE_SCOPE("initSettings");
+        
         // Set organization and application name for QSettings
         QCoreApplication::setOrganizationName("SecureTools");
         QCoreApplication::setApplicationName("PasswordGenerator");
@@ -567,37 +936,45 @@ private slots:
         // Force settings to use INI format on all platforms for better compatibility
         QSettings::setDefaultFormat(QSettings::IniFormat);
         
-        // Initialize settings
-        QSettings settings;
-        settings.sync();
+        // Read the settings once; from here on they live in memory and are
+        // written behind, at most every 500 ms
+        settingsStore = new SettingsStore(500, this);
     }
     
     void loadSettings() {
-        QSettings settings;
+        PWGEN_TRACE_SCOPE("loadSettings");
+        SettingsStore &settings = *settingsStore;
         
-        // Load window geometry and state if available
-        if (settings.contains("windowGeometry")) {
-            restoreGeometry(settings.value("windowGeometry").toByteArray());
-        }
-        
-        if (settings.contains("windowState")) {
-            restoreState(settings.value("windowState").toByteArray());
-        }
-        
-        // Load position and size explicitly as backup
-        if (settings.contains("windowX") && settings.contains("windowY")) {
-            int x = settings.value("windowX").toInt();
-            int y = settings.value("windowY").toInt();
-            move(x, y);
-        }
-        
-        if (settings.contains("windowWidth") && settings.contains("windowHeight")) {
-            int width = settings.value("windowWidth").toInt();
-            int height = settings.value("windowHeight").toInt();
-            resize(width, height);
+        {
+            PWGEN_TRACE_SCOPE("restoreGeometry");
+            
+            // Load window geometry and state if available
+            if (settings.contains("windowGeometry")) {
+                restoreGeometry(settings.value("windowGeometry").toByteArray());
+            }
+            
+            if (settings.contains("windowState")) {
+                restoreState(settings.value("windowState").toByteArray());
+            }
+            
+            // Load position and size explicitly as backup
+            if (settings.contains("windowX") && settings.contains("windowY")) {
+                int x = settings.value("windowX").toInt();
+                int y = settings.value("windowY").toInt();
+                move(x, y);
+            }
+            
+            if (settings.contains("windowWidth") && settings.contains("windowHeight")) {
+                int width = settings.value("windowWidth").toInt();
+                int height = settings.value("windowHeight").toInt();
+                resize(width, height);
+            }
         }
         
-        // Load password generation settings
+        // Load password generation settings. Read the passphrase ones first:
+        // every setter below auto-saves, which would overwrite them.
+        bool passphrase = settings.value("usePassphrase", false).toBool();
+        savedWords = settings.value("passphraseWords", 6).toInt();
         lengthSlider->setValue(settings.value("passwordLength", 20).toInt());
         
         // Character set options - load with defaults if not found
@@ -605,6 +982,7 @@ private slots:
         includeLowercase->setChecked(settings.value("includeLowercase", true).toBool());
         includeDigits->setChecked(settings.value("includeDigits", true).toBool());
         includeSpecial->setChecked(settings.value("includeSpecial", true).toBool());
+        usePassphrase->setChecked(passphrase);
         
         // Security options - load with defaults if not found
         // Explicitly handling avoidSimilarChars
@@ -614,22 +992,20 @@ private slots:
         enforceMinimumChars->setChecked(settings.value("enforceMinimumChars", true).toBool());
         autoClearClipboard->setChecked(settings.value("autoClearClipboard", true).toBool());
         
-        // Load font if available
-        QString fontName = settings.value("fontName", "Arial").toString();
-        int fontIndex = fontComboBox->findText(fontName, Qt::MatchContains);
-        if (fontIndex != -1) {
-            fontComboBox->setCurrentIndex(fontIndex);
-            QFont font(fontName, 12, QFont::Bold);
-            passwordField->setFont(font);
-        }
+        // Load font directly; the full list is only built on demand
+        selectFont(settings.value("fontName", "Arial").toString());
+        
+        // A policy file that has since gone away is dropped quietly
+        loadSitePolicy(settings.value("sitePolicyFile").toString(), false);
         
         // Update UI to reflect loaded settings
         updateLengthLabel(lengthSlider->value());
     }
     
     void saveSettings() {
-        // Create a new QSettings object to save the settings
-        QSettings settings;
+        // Only updates the in-memory store; unchanged values are skipped and
+        // the file is written in the background
+        SettingsStore &settings = *settingsStore;
         
         // Save window state and geometry
         settings.setValue("windowGeometry", saveGeometry());
@@ -641,8 +1017,11 @@ private slots:
         settings.setValue("windowWidth", width());
         settings.setValue("windowHeight", height());
         
-        // Save password generation settings
-        settings.setValue("passwordLength", lengthSlider->value());
+        // Save password generation settings; the slider holds whichever of
+        // the two the current mode uses
+        settings.setValue("passwordLength", passphraseMode ? savedLength : lengthSlider->value());
+        settings.setValue("passphraseWords", passphraseMode ? lengthSlider->value() : savedWords);
+        settings.setValue("usePassphrase", passphraseMode);
         
         // Character set options
         settings.setValue("includeUppercase", includeUppercase->isChecked());
@@ -660,12 +1039,12 @@ private slots:
         // Font settings
         settings.setValue("fontName", fontComboBox->currentText());
         
-        // Ensure settings are written immediately to disk
-        settings.sync();
+        settings.setValue("sitePolicyFile", sitePolicyFile);
     }
     
     void saveSettingsWithConfirmation() {
         saveSettings();
+        settingsStore->flushNow();
         QMessageBox::information(this, "Settings Saved", 
                                "Your current settings have been saved as the default.");
     }
@@ -679,6 +1058,8 @@ private slots:
         
         if (reply == QMessageBox::Yes) {
             // Reset to default values
+            usePassphrase->setChecked(false);
+            savedWords = 6;
             lengthSlider->setValue(20);
             
             includeUppercase->setChecked(true);
@@ -691,12 +1072,9 @@ private slots:
             autoClearClipboard->setChecked(true);
             
             // Reset font to Arial
-            int arialIndex = fontComboBox->findText("Arial", Qt::MatchContains);
-            if (arialIndex != -1) {
-                fontComboBox->setCurrentIndex(arialIndex);
-                QFont font("Arial", 12, QFont::Bold);
-                passwordField->setFont(font);
-            }
+            selectFont("Arial");
+            
+            loadSitePolicy(QString(), false);
             
             // Save these default settings
             saveSettings();
@@ -715,12 +1093,14 @@ private:
     SecurePasswordField *passwordField;
     QProgressBar *strengthMeter;
     QSlider *lengthSlider;
+    QLabel *lengthLabel;
     QLabel *lengthValue;
     QComboBox *fontComboBox;
     QCheckBox *includeUppercase;
     QCheckBox *includeLowercase;
     QCheckBox *includeDigits;
     QCheckBox *includeSpecial;
+    QCheckBox *usePassphrase;
     QCheckBox *enforceMinimumChars;
     QCheckBox *avoidSimilarChars;
     QCheckBox *autoClearClipboard;
@@ -729,31 +1109,61 @@ private:
     QPushButton *undoButton;
     QPushButton *saveSettingsButton;
     QPushButton *resetSettingsButton;
+    QLabel *sitePolicyName;
+    QPushButton *loadPolicyButton;
+    QPushButton *clearPolicyButton;
     
-    QList<QString> passwordHistory;
+    QList<pwgen::SecureBytes> passwordHistory;
     int currentHistoryIndex;
     
-    // Cryptographically secure random number generator
-    std::random_device rd;
-    std::mt19937_64 secureGenerator;
+    SettingsStore *settingsStore;
+    bool fontListLoaded = false;
+    
+    // Background strength scoring: strengthRequest counts text changes,
+    // evaluatingRequest is the change the running evaluation belongs to
+    QTimer *strengthDebounce;
+    QFutureWatcher<int> *strengthWatcher;
+    quint64 strengthRequest = 0;
+    quint64 evaluatingRequest = 0;
+    
+    // libpwgen context (compiled charset policy + ChaCha20 random source)
+    // and the options it was built from
+    struct ContextDeleter {
+        void operator()(pwgen_ctx *ctx) const { pwgen_free(ctx); }
+    };
+    std::unique_ptr<pwgen_ctx, ContextDeleter> generatorContext;
+    pwgen_options generatorOptions;
+    
+    // Passwords for the current settings, generated ahead on a background
+    // thread into locked memory; discarded when the settings change
+    pwgen::PasswordPool passwordPool;
+    
+    // Passphrase mode: the slider counts words, and the length slider value
+    // of the other mode is kept aside
+    bool passphraseMode = false;
+    int savedLength = 20;
+    int savedWords = 6;
+    std::unique_ptr<pwgen::PassphraseGenerator> passphraseGenerator;
+    
+    // Site policy: the file's rules, and their compiled form for the
+    // checkbox options and length it was last built for
+    QString sitePolicyFile;
+    pwgen::PolicySettings sitePolicySettings;
+    std::unique_ptr<pwgen::SitePolicy> sitePolicy;
+    std::unique_ptr<pwgen::SitePolicyGenerator> sitePolicyGenerator;
+    pwgen::CharsetOptions sitePolicyOptions;
     
     void initSecureRandom() {
-        // Seed with high-quality random data
-        std::array<unsigned int, std::mt19937_64::state_size> seedData;
-        std::random_device rd;
-        std::generate(seedData.begin(), seedData.end(), std::ref(rd));
-        
-        std::seed_seq seq(seedData.begin(), seedData.end());
-        secureGenerator.seed(seq);
+        PWGEN_TRACE_SCOPE("initSecureRandom");
+        pwgen_options_init(&generatorOptions);
+        generatorContext.reset(pwgen_ctx_new(&generatorOptions));
     }
     
     void saveToHistory(const QString &password) {
         if (!password.isEmpty()) {
-            passwordHistory.prepend(password);
+            passwordHistory.prepend(toSecureBytes(password));
             while (passwordHistory.size() > 10) {
-                // Securely clear the oldest password
-                QString &oldPassword = passwordHistory.last();
-                oldPassword.fill('X');  // Overwrite with 'X'
+                // The arena wipes the oldest password as it is freed
                 passwordHistory.removeLast();
             }
             undoButton->setEnabled(!passwordHistory.isEmpty());
@@ -761,10 +1171,7 @@ private:
     }
     
     void clearPasswordHistory() {
-        // Securely clear all passwords in history
-        for (QString &password : passwordHistory) {
-            password.fill('X');  // Overwrite with 'X'
-        }
+        // Every entry is wiped by the arena as it is freed
         passwordHistory.clear();
     }
     
@@ -775,117 +1182,157 @@ private:
                               bool useSpecial,
                               bool enforceMinimum,
                               bool avoidSimilar) {
-        // Ensure at least one character set is selected
-        if (!useUpper && !useLower && !useDigits && !useSpecial) {
-            // Default to lowercase if nothing selected
-            useLower = true;
-        }
-        
-        // Define character sets
-        const QString upperChars = avoidSimilar ? "ABCDEFGHJKLMNPQRSTUVWXYZ" : "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        const QString lowerChars = avoidSimilar ? "abcdefghijkmnopqrstuvwxyz" : "abcdefghijklmnopqrstuvwxyz";
-        const QString digitChars = avoidSimilar ? "23456789" : "0123456789";
-        const QString specialChars = "!@#$%^&*()-_=+[]{};:,.<>?/";
-        
-        // Combine selected character sets
-        QString chars;
-        if (useUpper) chars += upperChars;
-        if (useLower) chars += lowerChars;
-        if (useDigits) chars += digitChars;
-        if (useSpecial) chars += specialChars;
-        
-        // If enforcing minimum characters of each type
-        if (enforceMinimum) {
-            // Make sure length is sufficient for minimum requirements
-            int requiredLength = 0;
-            if (useUpper) requiredLength++;
-            if (useLower) requiredLength++;
-            if (useDigits) requiredLength++;
-            if (useSpecial) requiredLength++;
-            
-            if (length < requiredLength) {
-                length = requiredLength;
-                lengthSlider->setValue(length);
-            }
-            
-            // Generate password with at least one of each required character type
-            QString password;
-            
-            // First add one of each required type
-            if (useUpper) {
-                std::uniform_int_distribution<int> dist(0, upperChars.length() - 1);
-                password.append(upperChars.at(dist(secureGenerator)));
-            }
-            
-            if (useLower) {
-                std::uniform_int_distribution<int> dist(0, lowerChars.length() - 1);
-                password.append(lowerChars.at(dist(secureGenerator)));
-            }
-            
-            if (useDigits) {
-                std::uniform_int_distribution<int> dist(0, digitChars.length() - 1);
-                password.append(digitChars.at(dist(secureGenerator)));
-            }
-            
-            if (useSpecial) {
-                std::uniform_int_distribution<int> dist(0, specialChars.length() - 1);
-                password.append(specialChars.at(dist(secureGenerator)));
+        // Reuse the context unless the options changed since last time
+        pwgen_options options;
+        pwgen_options_init(&options);
+        options.use_upper = useUpper;
+        options.use_lower = useLower;
+        options.use_digits = useDigits;
+        options.use_special = useSpecial;
+        options.enforce_minimum = enforceMinimum;
+        options.avoid_similar = avoidSimilar;
+        
+        bool optionsChanged = options.use_upper != generatorOptions.use_upper ||
+                              options.use_lower != generatorOptions.use_lower ||
+                              options.use_digits != generatorOptions.use_digits ||
+                              options.use_special != generatorOptions.use_special ||
+                              options.enforce_minimum != generatorOptions.enforce_minimum ||
+                              options.avoid_similar != generatorOptions.avoid_similar;
+        if (!generatorContext || optionsChanged) {
+            generatorContext.reset(pwgen_ctx_new(&options));
+            generatorOptions = options;
+        }
+        if (!generatorContext) {
+            return QString();
+        }
+        
+        // Make sure length is sufficient for minimum requirements
+        int requiredLength = static_cast<int>(pwgen_min_length(generatorContext.get()));
+        if (length < requiredLength) {
+            length = requiredLength;
+            lengthSlider->setValue(length);
+        }
+        
+        // Take a ready password if the pool has one, otherwise generate
+        // straight into one arena buffer, wiped when it goes out of scope
+        pwgen::SecureBytes bytes(length);
+        if (!passwordPool.take(options, static_cast<size_t>(length), bytes.data()) &&
+            pwgen_generate(generatorContext.get(), bytes.data(), bytes.size()) != PWGEN_OK) {
+            return QString();
+        }
+        return QString::fromLatin1(bytes.data(), length);
+    }
+    
+    // Read a site policy file (an empty path clears it). A length in the file
+    // moves the slider. Unreadable files are reported only when `interactive`.
+    bool loadSitePolicy(const QString &path, bool interactive) {
+        pwgen::PolicySettings settings;
+        pwgen::PolicyRules rules;
+        std::string error;
+        if (!path.isEmpty() &&
+            (!pwgen::readPolicyFile(QFile::encodeName(path).toStdString(), settings, error) ||
+             !pwgen::applyPolicySettings(rules, settings, error))) {
+            if (interactive) {
+                QMessageBox::warning(this, "Site Policy Not Loaded", QString::fromStdString(error));
             }
-            
-            // Fill the rest randomly
-            while (password.length() < length) {
-                std::uniform_int_distribution<int> dist(0, chars.length() - 1);
-                password.append(chars.at(dist(secureGenerator)));
+            return false;
+        }
+        
+        sitePolicyFile = path;
+        sitePolicySettings.swap(settings);
+        sitePolicyGenerator.reset();
+        sitePolicy.reset();
+        sitePolicyName->setText(path.isEmpty() ? "None" : QFileInfo(path).fileName());
+        sitePolicyName->setToolTip(path);
+        clearPolicyButton->setEnabled(!path.isEmpty());
+        if (rules.length > 0 && !passphraseMode) {
+            lengthSlider->setValue(rules.length);
+        }
+        return true;
+    }
+    
+    // Password satisfying the site policy as well as the checkboxes, drawn
+    // uniformly from every password that does. The policy is recompiled only
+    // when the options or length change.
+    QString generatePolicyPassword(int length) {
+        pwgen::CharsetOptions options;
+        options.useUpper = includeUppercase->isChecked();
+        options.useLower = includeLowercase->isChecked();
+        options.useDigits = includeDigits->isChecked();
+        options.useSpecial = includeSpecial->isChecked();
+        options.enforceMinimum = enforceMinimumChars->isChecked();
+        options.avoidSimilar = avoidSimilarChars->isChecked();
+        
+        if (!sitePolicy || !(options == sitePolicyOptions) ||
+            sitePolicy->length() != static_cast<size_t>(length)) {
+            sitePolicyGenerator.reset();
+            sitePolicy.reset();
+            pwgen::PolicyRules rules = pwgen::policyRulesFrom(options);
+            std::string error;
+            if (!pwgen::applyPolicySettings(rules, sitePolicySettings, error)) {
+                QMessageBox::warning(this, "Site Policy", QString::fromStdString(error));
+                return QString();
             }
-            
-            // Shuffle the password to avoid predictable placement
-            std::shuffle(password.begin(), password.end(), secureGenerator);
-            
-            return password;
-        } else {
-            // Generate completely random password
-            QString password;
-            std::uniform_int_distribution<int> dist(0, chars.length() - 1);
-            
-            for (int i = 0; i < length; ++i) {
-                password.append(chars.at(dist(secureGenerator)));
+            try {
+                sitePolicy.reset(new pwgen::SitePolicy(rules, static_cast<size_t>(length)));
+            } catch (const std::invalid_argument &e) {
+                QMessageBox::warning(this, "Site Policy",
+                                     QString("The site policy can't be met: %1.").arg(e.what()));
+                return QString();
             }
-            
-            return password;
+            sitePolicyGenerator.reset(new pwgen::SitePolicyGenerator(*sitePolicy));
+            sitePolicyOptions = options;
         }
+        
+        pwgen::SecureBytes bytes(length);
+        sitePolicyGenerator->generate(bytes.data());
+        return QString::fromLatin1(bytes.data(), length);
     }
     
-    int calculatePasswordStrength(const QString &password) {
-        // Basic zxcvbn-inspired password strength evaluation
-        int score = 0;
-        
-        // Length contribution (up to 40 points)
-        score += qMin(40, password.length() * 2);
-        
-        // Character variety contribution (up to 30 points)
-        bool hasLower = false, hasUpper = false, hasDigit = false, hasSpecial = false;
-        for (const QChar &ch : password) {
-            if (ch.isLower()) hasLower = true;
-            else if (ch.isUpper()) hasUpper = true;
-            else if (ch.isDigit()) hasDigit = true;
-            else hasSpecial = true;
+    // Diceware passphrase from the memory-mapped wordlist, words joined by '-'
+    QString generatePassphrase(int words) {
+        const pwgen::Wordlist &wordlist = pwgen::defaultWordlist();
+        if (wordlist.empty()) {
+            return QString();
+        }
+        if (!passphraseGenerator) {
+            passphraseGenerator.reset(new pwgen::PassphraseGenerator(wordlist));
+        }
+        pwgen::SecureBytes phrase = passphraseGenerator->generate(static_cast<size_t>(words), "-");
+        return QString::fromUtf8(phrase.data(), static_cast<int>(phrase.size()));
+    }
+    
+    // calculatePasswordStrength() result for a password found in the
+    // breached-password corpus
+    static const int BREACHED_SCORE = -1;
+    
+    // Look the password up in the memory-mapped breached-password corpus
+    // (breach.h), if one is installed. Thread-safe.
+    static bool isBreached(const QString &password) {
+        const pwgen::BreachCorpus &corpus = pwgen::defaultBreachCorpus();
+        if (corpus.empty()) {
+            return false;
+        }
+        QByteArray bytes = password.toUtf8();
+        QByteArray digest = QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+        bool found = corpus.containsDigest(reinterpret_cast<const unsigned char *>(digest.constData()));
+        pwgen::secureZero(bytes.data(), bytes.size());
+        pwgen::secureZero(digest.data(), digest.size());
+        return found;
+    }
+    
+    // Runs on a QtConcurrent worker: touches nothing but its argument
+    static int calculatePasswordStrength(const QString &password) {
+        // Breached input is flagged whatever its score would be
+        if (isBreached(password)) {
+            return BREACHED_SCORE;
         }
         
-        int charTypeCount = (hasLower ? 1 : 0) + (hasUpper ? 1 : 0) + 
-                            (hasDigit ? 1 : 0) + (hasSpecial ? 1 : 0);
-        score += charTypeCount * 7.5;
-        
-        // Entropy approximation (up to 30 points)
-        double entropy = 0;
-        if (hasLower) entropy += 26;
-        if (hasUpper) entropy += 26;
-        if (hasDigit) entropy += 10;
-        if (hasSpecial) entropy += 33;
-        
-        entropy = log2(entropy) * password.length();
-        score += qMin(30.0, entropy / 4.0);
-        
-        return qMin(100, score);
+        // zxcvbn-style estimate against the memory-mapped dictionary
+        QByteArray bytes = password.toUtf8();
+        int score = pwgen::estimateStrength(bytes.constData(), bytes.size()).score;
+        pwgen::secureZero(bytes.data(), bytes.size());
+        return score;
     }
 };
 
@@ -893,8 +1340,24 @@ private:
 #include "main.moc"
 
 int main(int argc, char *argv[]) {
+    // Startup timings, written when the application exits (see startup_trace.h)
+    PWGEN_TRACE_SESSION();
+    for (int i = 1; i + 1 < argc; i++) {
+        if (qstrcmp(argv[i], "--startup-trace") == 0 && !pwgen::setStartupTraceOutput(argv[i + 1])) {
+            fprintf(stderr, "Warning: --startup-trace ignored, built without PWGEN_STARTUP_TRACE.\n");
+        }
+    }
+    
     QApplication app(argc, argv);
+    PWGEN_TRACE_MARK("QApplication");
+    
     PasswordGenerator window;
-    window.show();
+    {
+        PWGEN_TRACE_SCOPE("show");
+        window.show();
+    }
+    
+    // The first pass through the event loop is when the window is usable
+    QTimer::singleShot(0, &window, []() { PWGEN_TRACE_MARK("firstEvent"); });
     return app.exec();
 }
\ No newline at end of file
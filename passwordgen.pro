@@ -1,7 +1,54 @@
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 TARGET = passwordgenerator
 TEMPLATE = app
 
-SOURCES += main.cpp
-CONFIG += c++17
\ No newline at end of file
+SOURCES += main.cpp \
+           libpwgen/pwgen.cpp
+HEADERS += libpwgen/pwgen.h \
+           libpwgen/secure_random.h \
+           libpwgen/index_sampler.h \
+           libpwgen/charset_kernel.h \
+           libpwgen/charset_policy.h \
+           libpwgen/strength.h \
+           libpwgen/dictionary.h \
+           libpwgen/estimator.h \
+           libpwgen/password_pool.h \
+           libpwgen/secure_memory.h \
+           libpwgen/startup_trace.h \
+           libpwgen/wordlist.h \
+           libpwgen/sha1.h \
+           libpwgen/breach.h \
+           libpwgen/site_policy.h
+CONFIG += c++17
+
+# Startup profiling: `qmake CONFIG+=startup_trace`, then run with
+# --startup-trace trace.json
+startup_trace: DEFINES += PWGEN_STARTUP_TRACE
+
+# Strength estimator dictionary: compile the wordlists into pwgen.dict next to
+# the executable with the host compiler, before the application is linked
+DICT_LISTS = passwords=$$PWD/libpwgen/dict/passwords.txt \
+             english=$$PWD/libpwgen/dict/english.txt \
+             names=$$PWD/libpwgen/dict/names.txt
+pwdict.target = pwgen.dict
+pwdict.depends = $$PWD/libpwgen/dict/pwdictc.cpp \
+                 $$PWD/libpwgen/dict/passwords.txt \
+                 $$PWD/libpwgen/dict/english.txt \
+                 $$PWD/libpwgen/dict/names.txt
+pwdict.commands = $$QMAKE_CXX -std=c++11 -O2 -o pwdictc $$PWD/libpwgen/dict/pwdictc.cpp && \
+                  ./pwdictc -o pwgen.dict $$DICT_LISTS
+QMAKE_EXTRA_TARGETS += pwdict
+PRE_TARGETDEPS += pwgen.dict
+QMAKE_CLEAN += pwdictc pwgen.dict
+
+# Passphrase wordlist: compiled into pwgen.words next to the executable the
+# same way
+pwwords.target = pwgen.words
+pwwords.depends = $$PWD/libpwgen/dict/pwwordsc.cpp \
+                  $$PWD/libpwgen/dict/passphrase.txt
+pwwords.commands = $$QMAKE_CXX -std=c++11 -O2 -o pwwordsc $$PWD/libpwgen/dict/pwwordsc.cpp && \
+                   ./pwwordsc -o pwgen.words $$PWD/libpwgen/dict/passphrase.txt
+QMAKE_EXTRA_TARGETS += pwwords
+PRE_TARGETDEPS += pwgen.words
+QMAKE_CLEAN += pwwordsc pwgen.words